@@ -0,0 +1,75 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+// Cost of one processBlock call.
+struct BlockStats
+{
+    juce::int64 startTicks = 0;  // juce::Time::getHighResolutionTicks() at block start
+    float durationMs = 0.0f;
+    float load = 0.0f;           // duration / real-time length of the block
+    int numSamples = 0;
+    int activeVoices = 0;
+    int events = 0;              // MIDI events in the block
+};
+
+// Per-block timing written by the audio thread and read by the message
+// thread through a lock-free single producer / single consumer FIFO. When
+// nobody reads, new blocks are counted as dropped instead of blocking.
+class BlockTelemetry
+{
+public:
+    static constexpr int capacity = 2048;
+
+    // Audio thread
+    void record(const BlockStats& stats)
+    {
+        auto worst = worstDurationMs.load(std::memory_order_relaxed);
+        while (stats.durationMs > worst
+               && !worstDurationMs.compare_exchange_weak(worst, stats.durationMs, std::memory_order_relaxed)) {}
+
+        // Took longer than the audio it produced: the host would have glitched
+        // had it needed the block in real time
+        if (stats.load > 1.0f)
+            overruns.fetch_add(1, std::memory_order_relaxed);
+
+        if (fifo.getFreeSpace() == 0)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        const auto scope = fifo.write(1);
+        if (scope.blockSize1 > 0)
+            buffer[static_cast<size_t>(scope.startIndex1)] = stats;
+    }
+
+    // Message thread: copies up to maxBlocks pending entries, oldest first.
+    int read(BlockStats* dest, int maxBlocks)
+    {
+        const auto scope = fifo.read(juce::jmin(maxBlocks, fifo.getNumReady()));
+        for (int i = 0; i < scope.blockSize1; ++i)
+            dest[i] = buffer[static_cast<size_t>(scope.startIndex1 + i)];
+        for (int i = 0; i < scope.blockSize2; ++i)
+            dest[scope.blockSize1 + i] = buffer[static_cast<size_t>(scope.startIndex2 + i)];
+        return scope.blockSize1 + scope.blockSize2;
+    }
+
+    float getWorstDurationMs() const { return worstDurationMs.load(std::memory_order_relaxed); }
+    void resetWorstDuration()
+    {
+        worstDurationMs.store(0.0f, std::memory_order_relaxed);
+        overruns.store(0, std::memory_order_relaxed);
+    }
+    int getNumDropped() const { return dropped.load(std::memory_order_relaxed); }
+    int getNumOverruns() const { return overruns.load(std::memory_order_relaxed); }
+
+private:
+    juce::AbstractFifo fifo { capacity };
+    std::array<BlockStats, capacity> buffer;
+    std::atomic<float> worstDurationMs { 0.0f };
+    std::atomic<int> dropped { 0 };
+    std::atomic<int> overruns { 0 };
+};
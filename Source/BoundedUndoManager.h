@@ -0,0 +1,39 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// UndoManager with a fixed memory budget. Old transactions are dropped once
+// the stored actions exceed the limit, and a transaction that keeps growing
+// without a gesture to close it (host automation, MIDI control) is split
+// periodically so the limit can reclaim its older parts too.
+class BoundedUndoManager : public juce::UndoManager,
+                           private juce::Timer
+{
+public:
+    static constexpr int defaultMemoryLimitBytes = 256 * 1024;
+    static constexpr int maxActionsPerTransaction = 64;
+
+    explicit BoundedUndoManager(int memoryLimitBytes = defaultMemoryLimitBytes)
+    {
+        setMemoryLimit(memoryLimitBytes);
+        startTimer(1000);
+    }
+
+    // Undo action sizes are reported in bytes, so the limit is in bytes too.
+    // A few transactions are always kept, however large.
+    void setMemoryLimit(int bytes)
+    {
+        setMaxNumberOfStoredUnits(bytes, minTransactionsToKeep);
+    }
+
+private:
+    static constexpr int minTransactionsToKeep = 4;
+
+    void timerCallback() override
+    {
+        if (getNumActionsInCurrentTransaction() > maxActionsPerTransaction)
+            beginNewTransaction();
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BoundedUndoManager)
+};
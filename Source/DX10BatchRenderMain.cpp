@@ -0,0 +1,113 @@
+// Command line front end for DX10BatchRenderer. Not part of the plugin;
+// CMakeLists.txt builds it.
+
+#include "DX10BatchRenderer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+namespace
+{
+    const char* const parameterNames[NSNAPSHOTPARAMS] = {
+        "attack", "decay", "release", "coarse", "fine", "mod_init", "mod_decay", "mod_sustain",
+        "mod_release", "mod_velocity", "vibrato", "octave", "fine_tune", "waveform", "mod_thru", "lfo_rate",
+        "gain", "saturation", "glide", "spread", "pan_mode", "unison", "detune", "lfo_mode"
+    };
+
+    void printUsage()
+    {
+        std::printf("usage: dx10batch <output directory> [options]\n"
+                    "  --grid                  step every parameter range (default: random sampling)\n"
+                    "  --patches N             random patches to draw (default 1)\n"
+                    "  --seed N                random seed (default 1)\n"
+                    "  --param NAME=MIN:MAX[:STEPS]  range of one parameter, values 0-1\n"
+                    "  --notes 48,60,72        MIDI notes (default 60)\n"
+                    "  --velocities 64,127     velocities (default 100)\n"
+                    "  --rate HZ               sample rate (default 44100)\n"
+                    "  --note-seconds S        note length (default 1)\n"
+                    "  --tail-seconds S        render time after note off (default 1)\n"
+                    "  --array                 one float32 array instead of WAV files\n"
+                    "  --threads N             worker threads (default: all cores)\n"
+                    "parameters:");
+        for (auto* name : parameterNames)
+            std::printf(" %s", name);
+        std::printf("\n");
+    }
+
+    std::vector<int> parseList(const char* text)
+    {
+        std::vector<int> values;
+        std::stringstream stream(text);
+        for (std::string item; std::getline(stream, item, ',');)
+            values.push_back(std::atoi(item.c_str()));
+        return values;
+    }
+
+    bool parseRange(const char* text, DX10BatchSpec& spec)
+    {
+        const char* equals = std::strchr(text, '=');
+        if (equals == nullptr)
+            return false;
+
+        const std::string name(text, equals);
+        for (int i = 0; i < NSNAPSHOTPARAMS; ++i) {
+            if (name == parameterNames[i]) {
+                auto& range = spec.ranges[i];
+                range.steps = 1;
+                return std::sscanf(equals + 1, "%f:%f:%d", &range.min, &range.max, &range.steps) >= 2;
+            }
+        }
+        return false;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argv[1][0] == '-') {
+        printUsage();
+        return 1;
+    }
+
+    DX10BatchSpec spec;
+    auto output = DX10BatchRenderer::Output::wavFiles;
+    int numThreads = 0;
+
+    for (int i = 2; i < argc; ++i) {
+        const std::string option = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : "";
+
+        if (option == "--grid") { spec.mode = DX10BatchSpec::Mode::grid; continue; }
+        if (option == "--array") { output = DX10BatchRenderer::Output::float32Array; continue; }
+
+        ++i;
+        if (option == "--patches") spec.numRandomPatches = std::atoi(value);
+        else if (option == "--seed") spec.seed = std::strtoull(value, nullptr, 10);
+        else if (option == "--notes") spec.notes = parseList(value);
+        else if (option == "--velocities") spec.velocities = parseList(value);
+        else if (option == "--rate") spec.sampleRate = std::atof(value);
+        else if (option == "--note-seconds") spec.noteSeconds = std::atof(value);
+        else if (option == "--tail-seconds") spec.tailSeconds = std::atof(value);
+        else if (option == "--threads") numThreads = std::atoi(value);
+        else if (option == "--param" && parseRange(value, spec)) {}
+        else {
+            std::fprintf(stderr, "bad option: %s %s\n", option.c_str(), value);
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (spec.notes.empty() || spec.velocities.empty() || spec.sampleRate <= 0.0) {
+        printUsage();
+        return 1;
+    }
+
+    DX10BatchRenderer renderer(spec);
+    std::printf("rendering %lld jobs of %d frames\n", static_cast<long long>(renderer.getNumJobs()), renderer.getFramesPerJob());
+    if (!renderer.run(argv[1], output, numThreads)) {
+        std::fprintf(stderr, "could not write to %s\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
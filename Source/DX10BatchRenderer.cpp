@@ -0,0 +1,224 @@
+#include "DX10BatchRenderer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+namespace
+{
+    // Stateless 64-bit mixer, so each patch gets its own random stream that
+    // does not depend on which thread renders it or in what order.
+    std::uint64_t splitMix64(std::uint64_t x)
+    {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    void writeLE(std::ostream& out, std::uint32_t value, int numBytes)
+    {
+        for (int i = 0; i < numBytes; ++i)
+            out.put(char((value >> (8 * i)) & 0xFF));
+    }
+
+    bool writeWav(const std::string& path, const float* interleaved, int numFrames, double sampleRate)
+    {
+        std::ofstream out(path, std::ios::binary);
+        const std::uint32_t dataBytes = std::uint32_t(numFrames) * 2 * sizeof(float);
+
+        // IEEE float format: fmt chunk with cbSize, plus the fact chunk
+        out.write("RIFF", 4); writeLE(out, 4 + 26 + 12 + 8 + dataBytes, 4); out.write("WAVE", 4);
+        out.write("fmt ", 4); writeLE(out, 18, 4);
+        writeLE(out, 3, 2);                                         // WAVE_FORMAT_IEEE_FLOAT
+        writeLE(out, 2, 2);                                         // channels
+        writeLE(out, std::uint32_t(sampleRate), 4);
+        writeLE(out, std::uint32_t(sampleRate) * 2 * sizeof(float), 4);
+        writeLE(out, 2 * sizeof(float), 2);                         // block align
+        writeLE(out, 32, 2);                                        // bits per sample
+        writeLE(out, 0, 2);                                         // cbSize
+        out.write("fact", 4); writeLE(out, 4, 4); writeLE(out, std::uint32_t(numFrames), 4);
+        out.write("data", 4); writeLE(out, dataBytes, 4);
+        out.write(reinterpret_cast<const char*>(interleaved), dataBytes);
+        return bool(out);
+    }
+}
+
+DX10BatchSpec::DX10BatchSpec()
+{
+    const DX10EngineParameters defaults;
+    for (int i = 0; i < NSNAPSHOTPARAMS; ++i)
+        ranges[i].min = ranges[i].max = defaults[i];
+}
+
+DX10BatchRenderer::DX10BatchRenderer(const DX10BatchSpec& s)
+    : spec(s)
+{
+    if (spec.mode == DX10BatchSpec::Mode::grid) {
+        numPatches = 1;
+        for (const auto& range : spec.ranges)
+            numPatches *= std::max(range.steps, 1);
+    } else {
+        numPatches = std::max(spec.numRandomPatches, 0);
+    }
+    numJobs = numPatches * std::int64_t(spec.notes.size()) * std::int64_t(spec.velocities.size());
+    framesPerJob = int(std::lround((spec.noteSeconds + spec.tailSeconds) * spec.sampleRate));
+}
+
+DX10BatchJob DX10BatchRenderer::getJob(std::int64_t index) const
+{
+    DX10BatchJob job;
+    job.index = index;
+
+    // Velocity varies fastest, then note, then patch
+    const auto numVelocities = std::int64_t(spec.velocities.size());
+    const auto numNotes = std::int64_t(spec.notes.size());
+    job.velocity = spec.velocities[size_t(index % numVelocities)];
+    job.note = spec.notes[size_t((index / numVelocities) % numNotes)];
+    job.patch = index / (numVelocities * numNotes);
+
+    if (spec.mode == DX10BatchSpec::Mode::grid) {
+        auto rest = job.patch;
+        for (int i = 0; i < NSNAPSHOTPARAMS; ++i) {
+            const auto& range = spec.ranges[i];
+            const int steps = std::max(range.steps, 1);
+            const int step = int(rest % steps);
+            rest /= steps;
+            job.params[i] = steps > 1 ? range.min + (range.max - range.min) * float(step) / float(steps - 1) : range.min;
+        }
+    } else {
+        auto state = splitMix64(spec.seed ^ splitMix64(std::uint64_t(job.patch)));
+        for (int i = 0; i < NSNAPSHOTPARAMS; ++i) {
+            state = splitMix64(state);
+            const float unit = float(state >> 40) * (1.0f / 16777216.0f);  // 24 random bits in [0, 1)
+            const auto& range = spec.ranges[i];
+            job.params[i] = range.min + (range.max - range.min) * unit;
+        }
+    }
+    return job;
+}
+
+void DX10BatchRenderer::renderJob(const DX10BatchJob& job, float* interleaved) const
+{
+    DX10Engine engine;
+    engine.prepare(spec.sampleRate);
+    engine.setParams(job.params);
+
+    const int blockSize = std::max(spec.blockSize, 1);
+    const int noteOffFrame = int(std::lround(spec.noteSeconds * spec.sampleRate));
+    const std::uint8_t noteOn[3] = { 0x90, std::uint8_t(job.note & 0x7F), std::uint8_t(job.velocity & 0x7F) };
+    const std::uint8_t noteOff[3] = { 0x80, std::uint8_t(job.note & 0x7F), 0 };
+    engine.pushEvent(noteOn, 3, 0);
+
+    std::vector<float> left(static_cast<size_t>(blockSize)), right(static_cast<size_t>(blockSize));
+    float* outputs[2] = { left.data(), right.data() };
+
+    for (int start = 0; start < framesPerJob; start += blockSize) {
+        const int numSamples = std::min(blockSize, framesPerJob - start);
+        if (noteOffFrame >= start && noteOffFrame < start + numSamples)
+            engine.pushEvent(noteOff, 3, noteOffFrame - start);
+
+        engine.render(outputs, numSamples);
+        for (int i = 0; i < numSamples; ++i) {
+            interleaved[2 * (start + i)] = left[size_t(i)];
+            interleaved[2 * (start + i) + 1] = right[size_t(i)];
+        }
+    }
+}
+
+bool DX10BatchRenderer::run(const std::string& directory, Output output, int numThreads) const
+{
+    const std::string arrayPath = directory + "/renders.f32";
+    const auto bytesPerJob = std::streamoff(framesPerJob) * 2 * std::streamoff(sizeof(float));
+
+    if (output == Output::float32Array) {
+        // Size the array up front; workers then write their slices in place
+        std::ofstream create(arrayPath, std::ios::binary | std::ios::trunc);
+        if (numJobs > 0) {
+            create.seekp(bytesPerJob * numJobs - 1);
+            create.put(0);
+        }
+        if (!create)
+            return false;
+    }
+
+    if (numThreads <= 0)
+        numThreads = int(std::max(1u, std::thread::hardware_concurrency()));
+
+    std::atomic<std::int64_t> nextJob { 0 };
+    std::atomic<bool> failed { false };
+
+    auto worker = [&]() {
+        std::vector<float> interleaved(size_t(framesPerJob) * 2);
+        std::fstream array;
+        if (output == Output::float32Array)
+            array.open(arrayPath, std::ios::binary | std::ios::in | std::ios::out);
+
+        for (auto index = nextJob++; index < numJobs && !failed; index = nextJob++) {
+            renderJob(getJob(index), interleaved.data());
+
+            bool written;
+            if (output == Output::float32Array) {
+                array.seekp(bytesPerJob * index);
+                array.write(reinterpret_cast<const char*>(interleaved.data()), bytesPerJob);
+                written = bool(array);
+            } else {
+                char name[32];
+                std::snprintf(name, sizeof(name), "/%08lld.wav", static_cast<long long>(index));
+                written = writeWav(directory + name, interleaved.data(), framesPerJob, spec.sampleRate);
+            }
+            if (!written)
+                failed = true;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < numThreads; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads)
+        thread.join();
+
+    return !failed && writeIndex(directory + "/index.csv", output);
+}
+
+bool DX10BatchRenderer::writeIndex(const std::string& path, Output output) const
+{
+    static const char* const names[NSNAPSHOTPARAMS] = {
+        "attack", "decay", "release", "coarse", "fine", "mod_init", "mod_decay", "mod_sustain",
+        "mod_release", "mod_velocity", "vibrato", "octave", "fine_tune", "waveform", "mod_thru", "lfo_rate",
+        "gain", "saturation", "glide", "spread", "pan_mode", "unison", "detune", "lfo_mode"
+    };
+
+    std::ofstream out(path);
+    // Every row carries the render format as well, so renders.f32 can be
+    // mapped from the index alone
+    out << (output == Output::float32Array ? "job,frame_offset" : "job,file") << ",frames,sample_rate,channels,patch,note,velocity";
+    for (auto* name : names)
+        out << ',' << name;
+    out << '\n';
+
+    char value[32];
+    for (std::int64_t index = 0; index < numJobs; ++index) {
+        const auto job = getJob(index);
+        out << index << ',';
+        if (output == Output::float32Array) {
+            out << index * framesPerJob;
+        } else {
+            std::snprintf(value, sizeof(value), "%08lld.wav", static_cast<long long>(index));
+            out << value;
+        }
+        std::snprintf(value, sizeof(value), "%.9g", spec.sampleRate);
+        out << ',' << framesPerJob << ',' << value << ",2";
+        out << ',' << job.patch << ',' << job.note << ',' << job.velocity;
+        for (int i = 0; i < NSNAPSHOTPARAMS; ++i) {
+            std::snprintf(value, sizeof(value), "%.9g", double(job.params[i]));
+            out << ',' << value;
+        }
+        out << '\n';
+    }
+    return bool(out);
+}
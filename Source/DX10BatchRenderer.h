@@ -0,0 +1,90 @@
+#pragma once
+
+#include "DX10Engine.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Offline rendering of many patch / note / velocity combinations, one fresh
+// DX10Engine per combination, spread over worker threads. Every render
+// depends only on the spec and its job index, so the output is identical
+// for a given spec (seed included) whatever the thread count.
+struct DX10BatchSpec
+{
+    // Values a parameter takes. Grid mode steps evenly from min to max
+    // (one step = min only); random mode draws uniformly from [min, max].
+    struct Range
+    {
+        float min = 0.0f;
+        float max = 0.0f;
+        int steps = 1;
+    };
+
+    enum class Mode { grid, random };
+    Mode mode = Mode::random;
+
+    // Parameter ranges in DX10EngineParameters order; by default every
+    // parameter is fixed at the Log Drum value.
+    Range ranges[NSNAPSHOTPARAMS];
+
+    int numRandomPatches = 1;     // patches drawn in random mode
+    std::uint64_t seed = 1;
+
+    std::vector<int> notes { 60 };
+    std::vector<int> velocities { 100 };
+
+    double sampleRate = 44100.0;
+    double noteSeconds = 1.0;     // held before note off
+    double tailSeconds = 1.0;     // rendered after note off
+    int blockSize = 64;           // fixed, so results don't depend on the machine
+
+    DX10BatchSpec();
+};
+
+// One combination to render
+struct DX10BatchJob
+{
+    std::int64_t index = 0;
+    std::int64_t patch = 0;
+    int note = 60;
+    int velocity = 100;
+    DX10EngineParameters params;
+};
+
+class DX10BatchRenderer
+{
+public:
+    enum class Output
+    {
+        wavFiles,     // <directory>/<job index>.wav, 32-bit float stereo
+        float32Array  // <directory>/renders.f32: [job][frame][channel], little-endian
+    };
+
+
+    explicit DX10BatchRenderer(const DX10BatchSpec& spec);
+
+    std::int64_t getNumJobs() const { return numJobs; }
+    int getFramesPerJob() const { return framesPerJob; }
+
+    // Pure function of the spec: the same index always gives the same job.
+    DX10BatchJob getJob(std::int64_t index) const;
+
+    // Renders a job into interleaved stereo, getFramesPerJob() frames.
+    void renderJob(const DX10BatchJob& job, float* interleaved) const;
+
+    // Renders every job into the directory (which must exist) and writes
+    // index.csv next to the audio, one row per job: job, frame_offset (array)
+    // or file (WAV), frames, sample_rate, channels, patch, note, velocity and
+    // every parameter value. renders.f32 has no header; job n starts
+    // frame_offset * channels floats in. numThreads 0 uses every core.
+    // Returns false if any file could not be written.
+    bool run(const std::string& directory, Output output, int numThreads = 0) const;
+
+private:
+    bool writeIndex(const std::string& path, Output output) const;
+
+    DX10BatchSpec spec;
+    std::int64_t numPatches = 0;
+    std::int64_t numJobs = 0;
+    int framesPerJob = 0;
+};
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "DX10Engine.h"
+#include "DX10Resampler.h"
+#include "DX10Trace.h"
+#include "DX10Tuning.h"
+
+#include <algorithm>
+#include <cstdint>
+
+// Renders host blocks: feeds a block's MIDI to the engine at the right sample
+// positions, runs the resampler at an internal rate and skips blocks while
+// everything is silent. Plain C++ with no JUCE dependency, like the engine,
+// so the plugin and the headless stress test run the same loop; parameters,
+// modes and program changes stay the caller's business.
+template <typename Sample>
+class DX10BlockRenderer
+{
+public:
+    DX10BlockRenderer(BasicDX10Engine<Sample>& engine, DX10Resampler<Sample>& resampler)
+        : _engine(engine), _resampler(resampler) {}
+
+    BasicDX10Engine<Sample>& getEngine() { return _engine; }
+
+    // Whether the engine renders at an internal rate, for the resampler to
+    // convert to the host's. The caller prepares both.
+    void setResampling(bool resampling)
+    {
+        _resampling = resampling;
+        _idle = false;
+    }
+
+    bool isResampling() const { return _resampling; }
+
+    // Tuning that MIDI Tuning Standard messages change before it goes to the
+    // engine; without one they are ignored.
+    void setMidiTuning(DX10Tuning* tuning) { _midiTuning = tuning; }
+
+    // Call after resetting the engine or the resampler.
+    void reset() { _idle = false; }
+
+    // Set by a block that left the engine silent and the resampler rung out:
+    // a block without MIDI is then silence, and skip() stands in for render().
+    bool isIdle() const { return _idle; }
+
+    // Moves the engine's clock on by a block of numSamples without rendering
+    // it; the caller clears the outputs.
+    void skip(int numSamples)
+    {
+        if (_resampling) {
+            _engine.skip(_resampler.getInputNeeded(numSamples));
+            _resampler.skip(numSamples);
+        } else {
+            _engine.skip(numSamples);
+        }
+    }
+
+    // Renders numSamples frames into outputs[0] and outputs[1]. events is a
+    // range of MIDI messages in time order with data, numBytes and
+    // samplePosition members (juce::MidiBuffer's, for one). Program changes
+    // go to onProgramChange(channel, program) once the block is rendered up
+    // to them and everything before has been applied; the engine gets the
+    // rest.
+    template <typename Events, typename ProgramChange>
+    void render(Sample* const* outputs, int numSamples, const Events& events, ProgramChange&& onProgramChange)
+    {
+        _outputs = outputs;
+        _frame = 0;
+
+        {
+            DX10_ENGINE_TRACE_SCOPE("processEvents");
+            for (const auto& event : events) {
+                const int position = std::min(std::max(event.samplePosition, _frame), numSamples);
+
+                // Notes queued before it still start with the old program
+                if (event.numBytes == 2 && (event.data[0] & 0xF0) == 0xC0) {
+                    drainTo(position);
+                    onProgramChange(event.data[0] & 0x0F, int(event.data[1]));
+                    continue;
+                }
+
+                // MIDI Tuning Standard changes apply to notes started afterwards
+                if (event.numBytes > 2 && event.data[0] == 0xF0) {
+                    if (_midiTuning != nullptr && _midiTuning->applyMidiTuning(event.data + 1, event.numBytes - 2)) {
+                        drainTo(position);
+                        _engine.setTuning(*_midiTuning);
+                    }
+                    continue;
+                }
+
+                // Event offsets count engine samples, so at an internal rate the
+                // block is rendered up to every event and the event queued at 0
+                if (_resampling)
+                    renderTo(position);
+
+                // A dense block is rendered in pieces when the engine's note
+                // queue fills up
+                if (!_engine.pushEvent(event.data, event.numBytes, event.samplePosition - _frame)) {
+                    drainTo(position);
+                    ++_numRetries;
+                    if (!_engine.pushEvent(event.data, event.numBytes, event.samplePosition - _frame))
+                        ++_numDropped;
+                }
+            }
+        }
+
+        renderTo(numSamples);
+        _idle = _engine.isSilent() && (!_resampling || _resampler.isSilent());
+    }
+
+    // Events pushed again after the queue filled up, and events lost because
+    // even an empty queue refused them (never, for well-formed MIDI).
+    std::int64_t getNumRetries() const { return _numRetries; }
+    std::int64_t getNumDropped() const { return _numDropped; }
+
+private:
+    // Renders the block up to position. At an internal rate the engine fills
+    // the resampler's input, a piece at a time, and the resampler the block.
+    void renderTo(int position)
+    {
+        if (!_resampling) {
+            Sample* pieceOutputs[2] = { _outputs[0] + _frame, _outputs[1] + _frame };
+            _engine.render(pieceOutputs, position - _frame);
+            _frame = position;
+            return;
+        }
+        while (_frame < position) {
+            const int numFrames = std::min(position - _frame, _resampler.getMaxOutputFrames());
+            Sample* inputs[2] = { _resampler.getInput(0), _resampler.getInput(1) };
+            _engine.render(inputs, _resampler.getInputNeeded(numFrames));
+            Sample* pieceOutputs[2] = { _outputs[0] + _frame, _outputs[1] + _frame };
+            _resampler.process(pieceOutputs, numFrames);
+            _frame += numFrames;
+        }
+    }
+
+    // Renders up to position and applies every event queued so far. At an
+    // internal rate the block is rendered up to the last event already, so a
+    // zero-length render applies them instead.
+    void drainTo(int position)
+    {
+        renderTo(position);
+        if (_resampling) {
+            Sample* inputs[2] = { _resampler.getInput(0), _resampler.getInput(1) };
+            _engine.render(inputs, 0);
+        }
+    }
+
+    BasicDX10Engine<Sample>& _engine;
+    DX10Resampler<Sample>& _resampler;
+    DX10Tuning* _midiTuning = nullptr;
+    bool _resampling = false;
+    bool _idle = false;
+
+    // The block being rendered, and how far
+    Sample* const* _outputs = nullptr;
+    int _frame = 0;
+
+    std::int64_t _numRetries = 0;
+    std::int64_t _numDropped = 0;
+};
@@ -0,0 +1,857 @@
+#include "DX10Engine.h"
+#include "DX10NoteCache.h"
+#include "DX10Trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+// saveState() and restoreState() copy the engine as raw bytes
+static_assert(std::is_trivially_copyable<DX10Engine>::value, "DX10Engine state must be plain data");
+static_assert(std::is_trivially_copyable<DX10EngineDouble>::value, "DX10Engine state must be plain data");
+
+namespace
+{
+    // Folds a value into a 64-bit hash, for note cache keys
+    std::uint64_t mixHash(std::uint64_t hash, std::uint64_t value)
+    {
+        hash ^= value + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+        hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+        hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+        return hash ^ (hash >> 31);
+    }
+
+    // Scale between phase increments, where -1 to 1 is one cycle, and the
+    // 32-bit fixed point oscillator phases
+    const double phaseScale = 2147483648.0;
+
+    // Sine of a fixed point phase, for the LFOs
+    template <typename Sample>
+    Sample lfoValue(std::uint32_t phase)
+    {
+        return Sample(std::sin(3.14159265358979323846 / phaseScale * double(std::int32_t(phase))));
+    }
+
+    template <typename T>
+    std::uint64_t bitsOf(T value)
+    {
+        std::uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(value));
+        return bits;
+    }
+}
+
+template <typename Sample>
+BasicDX10Engine<Sample>::BasicDX10Engine()
+{
+    prepare(44100.0);
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::prepare(double sampleRate)
+{
+    _sampleRate = Sample(sampleRate);
+    _inverseSampleRate = 1.0f / _sampleRate;
+    reset();
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::reset()
+{
+    // Notes being recorded into the note cache keep what they have so far
+    if (_cache != nullptr)
+        for (auto& voice : _voices) detachCache(voice, false);
+
+    for (int v = 0; v < NPOOLVOICES; ++v) {
+        _voices[v].env = 0.0f;
+        _voices[v].channel = 0;
+        _voices[v].patch = 0;
+        _voices[v].dcar = 0.0f;
+        _voices[v].dcarTarget = 0.0f;
+        _voices[v].dcarGlide = 1.0f;
+        _voices[v].numLanes = 1;
+        _voices[v].modPitch = 0.0f;
+        for (int l = 0; l < NUNISON; ++l) {
+            _voices[v].detune[l] = 1.0f;
+            _voices[v].panLeft[l] = 1.0f;
+            _voices[v].panRight[l] = 1.0f;
+            _voices[v].car[l] = 0;
+            _voices[v].mod0[l] = 0.0f;
+            _voices[v].mod1[l] = 0.0f;
+            _voices[v].dmod[l] = 0.0f;
+        }
+        _voices[v].noteBend = 1.0f;
+        _voices[v].pressure = 1.0f;
+        _voices[v].richness = 0.0f;
+        _voices[v].noteBendStep = _voices[v].pressureStep = _voices[v].richnessStep = 0.0f;
+        _voices[v].modulation = _voices[v].modulationStep = 0.0f;
+        _voices[v].cdec = 0.99f;
+        _voices[v].cacheEntry = -1;
+        _voices[v].cacheRecording = false;
+    }
+    for (auto& channel : _channels) {
+        channel.modWheel = 0.0f;
+        channel.pitchBend = 1.0f;
+        channel.volume = 0.0035f;
+        channel.sustain = 0;
+        channel.lfoPhase = 0x40000000u;  // a quarter cycle in: the LFO starts at its peak
+        channel.modulationAmount = 0.0f;
+        channel.modulationStep = 0.0f;
+        channel.lastNote = -1;
+        channel.portamentoTimeCC = -1.0f;
+        channel.portamentoOnCC = false;
+        channel.noteBend = 1.0f;
+        channel.pressure = 0.0f;
+        channel.slide = 0.5f;
+    }
+    _numActiveVoices = 0;
+    _numEvents = 0;
+    _lfoStep = 0;
+    _panRandom = 1;
+
+    // Coefficients depend on the sample rate
+    for (auto& patch : _patches)
+        updatePatch(patch);
+
+    // Free-running voice LFOs start spread evenly around the cycle
+    for (int v = 0; v < NPOOLVOICES; ++v)
+        _voiceLfoPhase[v] = std::uint32_t((std::uint64_t(v) << 32) / NPOOLVOICES);
+    updateVoiceLfoRates(0);
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::setParams(const DX10EngineParameters& params)
+{
+    if (_cache != nullptr && hashVoiceParams(params) != _patches[0].voiceHash) detachPatch(0);
+    _patches[0].params = params;
+    updatePatch(_patches[0]);
+    updateVoiceLfoRates(0);
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::setChannelMode(ChannelMode mode)
+{
+    _channelMode = mode;
+    _mpe = (mode == ChannelMode::mpe);
+    _numChannels = (mode == ChannelMode::multiTimbral) ? NCHANNELS : 1;
+    _numVoices = (mode == ChannelMode::single) ? NVOICES : NPOOLVOICES;
+    reset();
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::setTuning(const DX10Tuning& tuning)
+{
+    _tuning = tuning;
+    ++_tuningVersion;
+    for (auto& patch : _patches)
+        updatePatch(patch);
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::setNoteCache(DX10NoteCache<Sample>* cache)
+{
+    // Voices go back to live synthesis before the cache changes
+    if (_cache != nullptr)
+        for (auto& voice : _voices) detachCache(voice, true);
+    _cache = cache;
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::setChannelParams(int channel, const DX10EngineParameters& params)
+{
+    if (channel < 1 || channel >= NCHANNELS) return;
+    if (_cache != nullptr && hashVoiceParams(params) != _patches[channel].voiceHash) detachPatch(channel);
+    _patches[channel].params = params;
+    updatePatch(_patches[channel]);
+    updateVoiceLfoRates(channel);
+    _channels[channel].patch = channel;
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::clearChannelParams(int channel)
+{
+    if (channel < 1 || channel >= NCHANNELS) return;
+    _channels[channel].patch = 0;
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::updatePatch(Patch& patch)
+{
+    const float* values = patch.params.values;
+
+    Sample param11 = values[11];
+    patch.tune = 8.175798915644f * _inverseSampleRate * std::pow(2.0f, std::floor(param11 * 6.9f) - 2.0f);
+    Sample param12 = values[12];
+    patch.fineTune = param12 + param12 - 1.0f;
+    patch.fineTuneRatio = std::exp(0.05776226505f * patch.fineTune);
+
+    // Phase increment of every note. Only the tuning, Octave, FineTune and
+    // the sample rate affect it, so it is usually left as it is.
+    if (patch.tableTune != patch.tune || patch.tableFineTuneRatio != patch.fineTuneRatio || patch.tableTuning != _tuningVersion) {
+        for (int note = 0; note < 128; ++note)
+            patch.noteIncrement[note] = patch.tune * (_tuning.pitch[note] * patch.fineTuneRatio);
+        patch.tableTune = patch.tune;
+        patch.tableFineTuneRatio = patch.fineTuneRatio;
+        patch.tableTuning = _tuningVersion;
+    }
+    Sample coarse = values[3];
+    coarse = std::floor(40.1f * coarse * coarse);
+    Sample fine = values[4];
+    if (fine < 0.5f) { fine = 0.2f * fine * fine; }
+    else { switch (int(8.9f * fine)) { case 4: fine = 0.25f; break; case 5: fine = 0.33333333f; break; case 6: fine = 0.50f; break; case 7: fine = 0.66666667f; break; default: fine = 0.75f; } }
+    patch.ratio = 1.570796326795f * (coarse + fine);
+    patch.velocitySensitivity = values[9];
+    Sample param10 = values[10];
+    patch.vibrato = 0.001f * param10 * param10;
+    Sample param0 = values[0];
+    patch.attack = 1.0f - std::exp(-_inverseSampleRate * std::exp(8.0f - 8.0f * param0));
+    Sample param1 = values[1];
+    if (param1 > 0.98f) { patch.decay = 1.0f; } else { patch.decay = std::exp(-_inverseSampleRate * std::exp(5.0f - 8.0f * param1)); }
+    Sample param2 = values[2];
+    patch.release = std::exp(-_inverseSampleRate * std::exp(5.0f - 5.0f * param2));
+    Sample param5 = values[5];
+    patch.modInitialLevel = 0.0002f * param5 * param5;
+    Sample param6 = values[6];
+    patch.modDecay = 1.0f - std::exp(-_inverseSampleRate * std::exp(6.0f - 7.0f * param6));
+    Sample param7 = values[7];
+    patch.modSustain = 0.0002f * param7 * param7;
+    Sample param8 = values[8];
+    patch.modRelease = 1.0f - std::exp(-_inverseSampleRate * std::exp(5.0f - 8.0f * param8));
+    Sample param13 = values[13];
+    patch.waveform = param13;
+    patch.richness = 0.50f - 3.0f * param13 * param13;
+    Sample param14 = values[14];
+    patch.modMix = 0.25f * param14 * param14;
+    Sample param15 = values[15];
+    const double lfoRate = 25.0 * param15 * param15;  // Hz
+    patch.lfoInc = std::uint32_t(std::llround(2.0 * phaseScale * lfoRate * CONTROLPERIOD * double(_inverseSampleRate)));
+    patch.lfoMode = static_cast<LfoMode>(int(values[23] * 2.99f));
+
+    // Output section
+    Sample gainParam = values[16];
+    patch.outputGain = std::pow(10.0f, (gainParam * 24.0f - 12.0f) / 20.0f);  // -12dB to +12dB
+    patch.saturation = values[17];
+
+    // Stereo / unison
+    patch.spread = values[19];
+    patch.randomPan = values[20] >= 0.5f;
+    patch.unison = 1 + int(values[21] * (NUNISON - 0.01f));
+    patch.detuneAmount = 0.25f * values[22];
+
+    patch.voiceHash = hashVoiceParams(patch.params);
+}
+
+template <typename Sample>
+std::uint64_t BasicDX10Engine<Sample>::hashVoiceParams(const DX10EngineParameters& params) const
+{
+    // Gain, Saturation and Glide don't change a note once it plays
+    std::uint64_t hash = bitsOf(_sampleRate);
+    for (int i = 0; i < NSNAPSHOTPARAMS; ++i) {
+        if (i != DX10EngineParameters::gain && i != DX10EngineParameters::saturation && i != DX10EngineParameters::glide)
+            hash = mixHash(hash, bitsOf(params[i]));
+    }
+    return hash;
+}
+
+template <typename Sample>
+bool BasicDX10Engine<Sample>::pushEvent(const std::uint8_t* data, int size, int sampleOffset)
+{
+    const int status = size > 0 ? (data[0] & 0xF0) : 0;
+    const bool pressure = (_mpe && size == 2 && status == 0xD0);
+    if (size != 3 && !pressure) return true;
+    if (status != 0x80 && status != 0x90 && status != 0xB0 && status != 0xE0 && !pressure) return true;
+    if (_numEvents == EVENTBUFFER) return false;
+
+    _events[_numEvents++] = { std::max(sampleOffset, 0), data[0], data[1], std::uint8_t(pressure ? 0 : data[2]) };
+    return true;
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::processEvent(const Event& event)
+{
+    const auto data1 = event.data1; const auto data2 = event.data2;
+    const int channel = (_channelMode == ChannelMode::single) ? 0 : (event.status & 0x0F);
+    Channel& C = _channels[controlChannel(channel)];
+
+    switch (event.status & 0xF0) {
+        case 0x80: // Note Off
+            noteOn(channel, data1 & 0x7F, 0);
+            break;
+
+        case 0x90: // Note On
+            noteOn(channel, data1 & 0x7F, data2 & 0x7F);
+            break;
+
+        case 0xB0: // Control Change
+            if (_mpe && data1 == 0x4A) {  // CC #74 - MPE slide
+                _channels[channel].slide = Sample(data2) / 127.0f;
+                break;
+            }
+            // Notes played from the note cache go live before anything modulates them
+            if (data1 == 0x01 || data1 > 0x7A) detachChannel(controlChannel(channel));
+            switch (data1) {
+                case 0x01: C.modWheel = 0.00000005f * Sample(data2 * data2); break;
+                case 0x05: // CC #5 - Portamento Time (overrides knob if received)
+                    C.portamentoTimeCC = Sample(data2) / 127.0f;
+                    break;
+                case 0x07: C.volume = 0.00000035f * Sample(data2 * data2); break;
+                case 0x40: C.sustain = data2 & 0x40;
+                    if (C.sustain == 0) noteOn(controlChannel(channel), SUSTAIN, 0);
+                    break;
+                case 0x41: // CC #65 - Portamento On/Off (overrides knob if received)
+                    C.portamentoOnCC = (data2 >= 64);
+                    break;
+                default:
+                    if (data1 > 0x7A) {
+                        for (int v = 0; v < _numVoices; ++v) if (controlChannel(_voices[v].channel) == controlChannel(channel)) _voices[v].cdec = 0.99f;
+                        C.sustain = 0;
+                    }
+                    break;
+            }
+            break;
+
+        case 0xE0: // Pitch Bend
+            if (_mpe && channel != 0) {
+                // Per-note bend of an MPE member channel, +/-48 semitones
+                _channels[channel].noteBend = std::exp(0.05776226505f * 48.0f / 8192.0f * Sample(data1 + 128 * data2 - 8192));
+                break;
+            }
+            detachChannel(controlChannel(channel));
+            C.pitchBend = Sample(data1 + 128 * data2 - 8192);
+            C.pitchBend = (C.pitchBend > 0.0f) ? 1.0f + 0.000014951f * C.pitchBend : 1.0f + 0.000013318f * C.pitchBend;
+            break;
+
+        case 0xD0: // Channel Pressure (MPE only)
+            _channels[channel].pressure = Sample(data1) / 127.0f;
+            break;
+
+        default: break;
+    }
+    _numActiveVoices = countActiveVoices();
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::render(Sample* const* outputs, int numSamples)
+{
+    Sample *out1 = outputs[0];
+    Sample *out2 = outputs[1];
+    int frame = 0;
+
+    // Render up to each event, then apply it
+    for (int event = 0; event < _numEvents; ++event) {
+        const int eventFrame = std::min(std::max(_events[event].frame, frame), numSamples);
+        renderVoices(out1 + frame, out2 + frame, eventFrame - frame);
+        frame = eventFrame;
+        processEvent(_events[event]);
+    }
+    renderVoices(out1 + frame, out2 + frame, numSamples - frame);
+    _numEvents = 0;
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::renderVoices(Sample* out1, Sample* out2, int numFrames)
+{
+    if (_numActiveVoices == 0) {
+        std::fill(out1, out1 + numFrames, 0.0f);
+        std::fill(out2, out2 + numFrames, 0.0f);
+        skip(numFrames);
+        return;
+    }
+
+    // The output section belongs to the whole mix
+    const Sample saturation = _patches[0].saturation;
+    const Sample outputGain = _patches[0].outputGain;
+
+    int frames = numFrames;
+    while (--frames >= 0) {
+        Voice<Sample> *V = _voices;
+        Sample o1 = 0.0f, o2 = 0.0f;
+        if (--_lfoStep < 0) lfoTick();
+        for (int v = 0; v < _numVoices; ++v) {
+            if (V->cacheEntry >= 0 && !V->cacheRecording) {
+                playCached(*V, o1, o2);
+            } else if (V->env > SILENCE) {
+                // A recording keeps the voice state at the start of each block
+                if (V->cacheRecording && !_cache->prepareFrame(V->cacheEntry, *V))
+                    detachCache(*V, false);
+
+                Sample left, right;
+                renderVoice(*V, left, right);
+                const Sample voiceLeft = V->cenv * left;
+                const Sample voiceRight = V->cenv * right;
+                o1 += voiceLeft;
+                o2 += voiceRight;
+
+                if (V->cacheRecording) {
+                    _cache->recordFrame(V->cacheEntry, voiceLeft, voiceRight, V->env);
+
+                    // The note is over, or the next control tick would
+                    // silence the modulator at a point that depends on
+                    // when the note started
+                    if (V->env <= SILENCE || V->menv < SILENCE) {
+                        _cache->finishRecording(V->cacheEntry, *V, true);
+                        V->cacheEntry = -1;
+                        V->cacheRecording = false;
+                    }
+                }
+            }
+            V++;
+        }
+
+        // Apply saturation (soft clipping)
+        if (saturation > 0.0f) {
+            Sample satAmount = saturation * 4.0f;
+            const bool mono = (o1 == o2);  // centred voices: one tanh does both
+            o1 = std::tanh(o1 * (1.0f + satAmount)) / (1.0f + satAmount * 0.5f);
+            o2 = mono ? o1 : std::tanh(o2 * (1.0f + satAmount)) / (1.0f + satAmount * 0.5f);
+        }
+
+        // Apply output gain
+        o1 *= outputGain;
+        o2 *= outputGain;
+
+        *out1++ = o1; *out2++ = o2;
+    }
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::skip(int numSamples)
+{
+    // Nothing to hear, but the LFO clock keeps running exactly as if the
+    // samples had been rendered
+    for (int frames = numSamples; frames > 0;) {
+        if (frames <= _lfoStep) { _lfoStep -= frames; break; }
+        frames -= _lfoStep + 1;
+        lfoTick();
+    }
+}
+
+template <typename Sample>
+double BasicDX10Engine<Sample>::getReleaseSeconds(const DX10EngineParameters& params)
+{
+    // A released note's level is multiplied by exp(-rate / sample rate) every
+    // sample. It starts from at most Waveform 0, velocity 127 and CC 7 at 127.
+    const double release = params[DX10EngineParameters::release];
+    const double rate = std::exp(5.0 - 5.0 * release);
+    const double loudest = 1.5 * (0.00000035 * 127.0 * 127.0) * (127 + 10);
+    return std::log(loudest / SILENCE) / rate;
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::renderVoice(Voice<Sample>& V, Sample& left, Sample& right) const
+{
+    // One frame of an active voice: its lanes mixed down, before the
+    // carrier envelope
+    const Sample e = V.env;
+    const Patch& P = _patches[V.patch];
+    const Channel& C = _channels[controlChannel(V.channel)];
+
+    // MPE expression, stepped towards the values read at the last control tick
+    Sample bend = C.pitchBend, modScale = 1.0f, richness = P.richness;
+    const Sample modulation = V.modulation;
+    V.modulation += V.modulationStep;
+    if (_mpe) {
+        bend *= V.noteBend; modScale = V.pressure; richness = V.richness;
+        V.noteBend += V.noteBendStep;
+        V.pressure += V.pressureStep;
+        V.richness += V.richnessStep;
+    }
+
+    // Apply pitch glide/portamento
+    if (V.dcarGlide < 1.0f && std::abs(V.dcar - V.dcarTarget) > 0.00001f) {
+        V.dcar += V.dcarGlide * (V.dcarTarget - V.dcar);
+    } else {
+        V.dcar = V.dcarTarget;
+    }
+
+    // Calculate current pitch with pitch bend applied
+    Sample currentPitch = V.dcar * bend;
+
+    V.env = e * V.cdec;
+    V.cenv += V.catt * (e - V.cenv);
+
+    // Update modulator with current pitch (including pitch bend). The cosines
+    // only change with glide, pitch bend or the ratio, so held notes skip them.
+    Sample modPitch = P.ratio * currentPitch;
+    if (modPitch != V.modPitch) {
+        V.modPitch = modPitch;
+        for (int l = 0; l < V.numLanes; ++l)
+            V.dmod[l] = 2.0f * std::cos(modPitch * V.detune[l]);
+    }
+
+    V.menv += V.mdec * (V.mlev - V.menv);
+    const Sample modLevel = V.menv * modScale;
+
+    // The carrier's phase advance is rounded into fixed point through 64 bits,
+    // so a modulation deep enough to pass a whole cycle still wraps exactly
+    // and there is no branch in the lane loop
+    const Sample toPhase = Sample(phaseScale), fromPhase = Sample(1.0 / phaseScale);
+    left = 0.0f;
+    right = 0.0f;
+    for (int l = 0; l < V.numLanes; ++l) {
+        Sample y = V.dmod[l] * V.mod0[l] - V.mod1[l]; V.mod1[l] = V.mod0[l]; V.mod0[l] = y;
+        const Sample advance = currentPitch * V.detune[l] + y * modLevel + modulation;
+        V.car[l] += std::uint32_t(std::llrint(advance * toPhase));
+        const Sample x = Sample(std::int32_t(V.car[l])) * fromPhase;
+        Sample s = x + x * x * x * (richness * x * x - 1.0f - richness);
+        Sample lane = P.modMix * V.mod1[l] + s;
+        left += V.panLeft[l] * lane;
+        right += V.panRight[l] * lane;
+    }
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::lfoTick()
+{
+    const Sample steps = 1.0f / Sample(CONTROLPERIOD);
+    for (int c = 0; c < _numChannels; ++c) {
+        Channel& C = _channels[c];
+        const Patch& P = _patches[C.patch];
+        C.lfoPhase += P.lfoInc;
+        const Sample modulation = lfoValue<Sample>(C.lfoPhase) * (C.modWheel + P.vibrato);
+        C.modulationStep = (modulation - C.modulationAmount) * steps;
+        C.modulationAmount = modulation;
+    }
+    for (int v = 0; v < NPOOLVOICES; ++v)
+        _voiceLfoPhase[v] += _voiceLfoInc[v];
+    _lfoStep = CONTROLPERIOD - 1;
+
+    for (int v = 0; v < _numVoices; ++v) {
+        Voice<Sample>& V = _voices[v];
+        if (V.env < SILENCE) { V.env = 0.0f; V.cenv = 0.0f; }
+        if (V.menv < SILENCE) { V.menv = 0.0f; V.mlev = 0.0f; }
+        if (V.env > SILENCE) {
+            // Ramp the vibrato to its new value over the next CONTROLPERIOD
+            // samples instead of jumping there
+            const Patch& P = _patches[V.patch];
+            const Channel& C = _channels[controlChannel(V.channel)];
+            const Sample modulation = P.lfoMode == LfoMode::shared ? C.modulationAmount : lfoValue<Sample>(_voiceLfoPhase[v]) * (C.modWheel + P.vibrato);
+            V.modulationStep = (modulation - V.modulation) * steps;
+            if (_mpe) updateExpression(V, true);
+        }
+    }
+    _numActiveVoices = countActiveVoices();
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::updateExpression(Voice<Sample>& voice, bool ramp) const
+{
+    const Channel& N = _channels[voice.channel];
+    const Patch& P = _patches[voice.patch];
+
+    // Pressure raises the modulator level up to three times; slide moves
+    // the Waveform setting by up to half its range either way
+    const Sample pressure = 1.0f + 2.0f * N.pressure;
+    const Sample waveform = std::min<Sample>(std::max<Sample>(P.waveform + N.slide - 0.5f, 0.0f), 1.0f);
+    const Sample richness = 0.50f - 3.0f * waveform * waveform;
+
+    if (ramp) {
+        const Sample steps = 1.0f / Sample(CONTROLPERIOD);
+        voice.noteBendStep = (N.noteBend - voice.noteBend) * steps;
+        voice.pressureStep = (pressure - voice.pressure) * steps;
+        voice.richnessStep = (richness - voice.richness) * steps;
+    } else {
+        voice.noteBend = N.noteBend;
+        voice.pressure = pressure;
+        voice.richness = richness;
+        voice.noteBendStep = voice.pressureStep = voice.richnessStep = 0.0f;
+    }
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::updateVoiceLfoRates(int patch)
+{
+    for (int v = 0; v < NPOOLVOICES; ++v)
+        if (_voices[v].patch == patch) _voiceLfoInc[v] = _patches[patch].lfoInc;
+}
+
+template <typename Sample>
+int BasicDX10Engine<Sample>::countActiveVoices() const
+{
+    int count = 0;
+    for (int v = 0; v < _numVoices; ++v)
+        if (_voices[v].env > SILENCE) ++count;
+    return count;
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::noteOn(int channel, int note, int velocity)
+{
+    DX10_ENGINE_TRACE_SCOPE("noteOn");
+    Channel& C = _channels[controlChannel(channel)];
+
+    if (velocity > 0) {
+        const int patch = (_channelMode == ChannelMode::multiTimbral) ? _channels[channel].patch : 0;
+        const Patch& P = _patches[patch];
+
+        // Base pitch from the patch's note table (without pitch bend - bend
+        // is applied in render). Keys the tuning leaves unmapped stay silent.
+        Sample targetDcar = P.noteIncrement[note];
+        if (targetDcar <= 0.0f) return;
+        Sample p = _tuning.pitch[note] * P.fineTuneRatio;
+
+        Sample l = 1.0f; int vl = 0;
+        for (int v = 0; v < _numVoices; v++) { if (_voices[v].env < l) { l = _voices[v].env; vl = v; } }
+        Voice<Sample>& V = _voices[vl];
+        detachCache(V, false);
+
+        V.note = note;
+        V.channel = channel;
+        V.patch = patch;
+
+        // Check if glide should be applied (either via knob or CC)
+        Sample glideTime = (C.portamentoTimeCC >= 0.0f) ? C.portamentoTimeCC : P.params[DX10EngineParameters::glide];
+        bool useGlide = (glideTime > 0.01f) || C.portamentoOnCC;
+        const bool glides = useGlide && C.lastNote >= 0 && C.lastNote != note;
+        if (glides) {
+            // Start from last note pitch, glide to new pitch
+            V.dcar = P.noteIncrement[C.lastNote];
+            V.dcarTarget = targetDcar;
+            if (glideTime < 0.01f) {
+                V.dcarGlide = 1.0f;  // Instant (no glide)
+            } else {
+                // glideTime 0-1 maps to approximately 5ms to 2000ms glide time.
+                // The rate is the fraction of the distance to cover per sample:
+                // after N samples we want to be ~95% there, so 1 - e^(-3/N).
+                Sample glideSeconds = 0.005f + glideTime * glideTime * 2.0f;
+                Sample samplesForGlide = glideSeconds * _sampleRate;
+                V.dcarGlide = 1.0f - std::exp(-3.0f / samplesForGlide);
+            }
+            // Don't reset carrier phase for smooth glide
+        } else {
+            // No glide - instant pitch
+            V.dcar = targetDcar;
+            V.dcarTarget = targetDcar;
+            V.dcarGlide = 1.0f;
+            for (int i = 0; i < NUNISON; ++i) V.car[i] = 0;  // Reset phase only for non-glide notes
+        }
+
+        C.lastNote = note;  // Remember this note for next glide
+
+        if (p > 50.0f) p = 50.0f;
+        p *= (64.0f + P.velocitySensitivity * (velocity - 64));
+        V.menv = P.modInitialLevel * p;
+        V.mlev = P.modSustain * p;
+        V.mdec = P.modDecay;
+
+        // Stereo position: by key (C1 hard left to C7 hard right at full
+        // spread) or drawn at random for each note
+        _panRandom = _panRandom * 1664525u + 1013904223u;
+        Sample pan = P.randomPan ? Sample(_panRandom >> 8) * (2.0f / 16777216.0f) - 1.0f
+                                : std::min<Sample>(std::max<Sample>(Sample(note - 60) / 36.0f, -1.0f), 1.0f);
+        pan *= P.spread;
+
+        // Unison lanes sit evenly between the outer detune amounts and fan
+        // out across the stereo field around the note's position, at equal
+        // total power. A single lane is the plain DX10 voice.
+        V.numLanes = P.unison;
+        const Sample laneGain = P.unison > 1 ? 1.0f / std::sqrt(Sample(P.unison)) : 1.0f;
+        for (int i = 0; i < P.unison; ++i) {
+            const Sample position = P.unison > 1 ? Sample(2 * i) / Sample(P.unison - 1) - 1.0f : 0.0f;
+            const Sample lanePan = std::min<Sample>(std::max<Sample>(pan + P.spread * position, -1.0f), 1.0f);
+            V.detune[i] = std::exp(0.05776226505f * P.detuneAmount * position);
+            V.panLeft[i] = laneGain * std::min<Sample>(1.0f - lanePan, 1.0f);
+            V.panRight[i] = laneGain * std::min<Sample>(1.0f + lanePan, 1.0f);
+
+            const Sample dmod = P.ratio * V.dcar * V.detune[i];
+            V.mod0[i] = 0.0f;
+            V.mod1[i] = std::sin(dmod);
+            V.dmod[i] = 2.0f * std::cos(dmod);
+        }
+        V.modPitch = P.ratio * V.dcar;
+
+        V.env = (1.5f - P.waveform) * C.volume * (velocity + 10);
+        V.cdec = P.decay;
+        V.catt = P.attack;
+        V.cenv = 0.0f;
+
+        // Vibrato: a shared LFO is joined partway along its current ramp; a
+        // key-synced one restarts at a rising zero crossing
+        _voiceLfoInc[vl] = P.lfoInc;
+        if (P.lfoMode == LfoMode::keySync) _voiceLfoPhase[vl] = 0;
+        if (P.lfoMode == LfoMode::shared) {
+            V.modulationStep = C.modulationStep;
+            V.modulation = C.modulationAmount - Sample(_lfoStep) * C.modulationStep;
+        } else {
+            V.modulation = lfoValue<Sample>(_voiceLfoPhase[vl]) * (C.modWheel + P.vibrato);
+            V.modulationStep = 0.0f;
+        }
+
+        // A new note starts from its channel's expression as it stands
+        if (_mpe) {
+            updateExpression(V, false);
+        } else {
+            V.noteBend = V.pressure = 1.0f;
+            V.noteBendStep = V.pressureStep = V.richnessStep = 0.0f;
+        }
+
+        // Notes nothing modulates sound the same every time, so they can
+        // come from the note cache. Control ticks leave them alone as long
+        // as both envelopes stay above SILENCE.
+        if (_cache != nullptr && !_mpe && !glides && C.pitchBend == 1.0f && C.modWheel == 0.0f
+            && V.modulation == 0.0f && V.modulationStep == 0.0f && P.vibrato == 0.0f && !(P.randomPan && P.spread != 0.0f)
+            && V.env > SILENCE && V.menv >= SILENCE) {
+            std::uint64_t key = mixHash(P.voiceHash, std::uint64_t(note));
+            key = mixHash(key, std::uint64_t(velocity));
+            key = mixHash(key, bitsOf(targetDcar));
+            key = mixHash(key, bitsOf(p));
+            key = mixHash(key, bitsOf(C.volume));
+            startCache(V, key);
+        }
+    } else {
+        for (int v = 0; v < _numVoices; v++) {
+            // The sustain pedal lets go of every note sharing its controllers
+            const bool owner = (note == SUSTAIN) ? controlChannel(_voices[v].channel) == channel : _voices[v].channel == channel;
+            if (_voices[v].note == note && owner) {
+                const Patch& P = _patches[_voices[v].patch];
+                if (C.sustain == 0) { detachCache(_voices[v], true); _voices[v].cdec = P.release; _voices[v].env = _voices[v].cenv; _voices[v].catt = 1.0f; _voices[v].mlev = 0.0f; _voices[v].mdec = P.modRelease; }
+                else { _voices[v].note = SUSTAIN; }
+            }
+        }
+    }
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::startCache(Voice<Sample>& voice, std::uint64_t key)
+{
+    // Play the note back if it has been recorded; a note still being
+    // recorded by another voice is played live
+    int entry = _cache->find(key);
+    if (entry >= 0) {
+        const auto& E = _cache->getEntry(entry);
+        if (E.recording || E.numFrames == 0) return;
+        _cache->acquire(entry);
+        voice.cacheEntry = entry;
+        voice.cacheBlock = E.firstBlock;
+        voice.cacheFrame = 0;
+        voice.cacheRecording = false;
+        return;
+    }
+
+    entry = _cache->create(key);
+    if (entry < 0) return;
+    _cache->acquire(entry);
+    _cache->getEntry(entry).recording = true;
+    voice.cacheEntry = entry;
+    voice.cacheRecording = true;
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::playCached(Voice<Sample>& voice, Sample& o1, Sample& o2)
+{
+    const auto& block = _cache->getBlock(voice.cacheBlock);
+    const int frame = voice.cacheFrame % DX10NoteCache<Sample>::BLOCKFRAMES;
+    o1 += block.left[frame];
+    o2 += block.right[frame];
+    voice.env = block.env[frame];
+
+    auto& entry = _cache->getEntry(voice.cacheEntry);
+    if (++voice.cacheFrame == entry.numFrames) {
+        // Out of frames: carry on live, and record the rest of the note if
+        // the entry stopped short of its end
+        resumeFrom(voice, entry.end);
+        if (!entry.complete && !entry.recording) {
+            entry.recording = true;
+            voice.cacheRecording = true;
+        } else {
+            detachCache(voice, false);
+        }
+    } else if (frame + 1 == DX10NoteCache<Sample>::BLOCKFRAMES) {
+        voice.cacheBlock = block.next;
+    }
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::resumeFrom(Voice<Sample>& voice, const Voice<Sample>& state)
+{
+    // Only the sound comes from the saved state; the note, its channel and
+    // patch and its cache position are the voice's own
+    Voice<Sample> resumed = state;
+    resumed.note = voice.note;
+    resumed.channel = voice.channel;
+    resumed.patch = voice.patch;
+    resumed.cacheEntry = voice.cacheEntry;
+    resumed.cacheBlock = voice.cacheBlock;
+    resumed.cacheFrame = voice.cacheFrame;
+    resumed.cacheRecording = voice.cacheRecording;
+    voice = resumed;
+}
+
+template <typename Sample>
+Voice<Sample> BasicDX10Engine<Sample>::playbackState(const Voice<Sample>& voice) const
+{
+    // The live state saved at the start of the block, rendered forward to
+    // the current frame
+    Voice<Sample> state = _cache->getBlock(voice.cacheBlock).start;
+    state.channel = voice.channel;
+    state.patch = voice.patch;
+    Sample left, right;
+    for (int frame = voice.cacheFrame % DX10NoteCache<Sample>::BLOCKFRAMES; frame > 0; --frame)
+        renderVoice(state, left, right);
+    return state;
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::detachCache(Voice<Sample>& voice, bool resume)
+{
+    if (voice.cacheEntry < 0) return;
+
+    if (voice.cacheRecording) {
+        // The voice is live already; what it recorded so far stays valid
+        _cache->finishRecording(voice.cacheEntry, voice, false);
+    } else {
+        if (resume) resumeFrom(voice, playbackState(voice));
+        _cache->release(voice.cacheEntry);
+    }
+    voice.cacheEntry = -1;
+    voice.cacheRecording = false;
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::detachChannel(int channel)
+{
+    if (_cache == nullptr) return;
+    for (int v = 0; v < _numVoices; ++v)
+        if (controlChannel(_voices[v].channel) == channel) detachCache(_voices[v], true);
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::detachPatch(int patch)
+{
+    for (int v = 0; v < _numVoices; ++v)
+        if (_voices[v].patch == patch) detachCache(_voices[v], true);
+}
+
+template <typename Sample>
+void BasicDX10Engine<Sample>::saveState(void* dest) const
+{
+    // The saved state never refers to the note cache: voices playing from it
+    // are saved live, as detachCache() would resume them, and recordings are
+    // saved as the live voices they are. The cache itself is left untouched.
+    BasicDX10Engine state(*this);
+    state._cache = nullptr;
+    for (int v = 0; v < NPOOLVOICES; ++v) {
+        Voice<Sample>& voice = state._voices[v];
+        if (voice.cacheEntry >= 0 && !voice.cacheRecording) state.resumeFrom(voice, playbackState(_voices[v]));
+        voice.cacheEntry = -1;
+        voice.cacheRecording = false;
+    }
+    std::memcpy(dest, &state, sizeof(state));
+}
+
+template <typename Sample>
+bool BasicDX10Engine<Sample>::restoreState(const void* source, std::size_t size)
+{
+    if (size != sizeof(*this)) return false;
+
+    // The engine keeps its own cache; its voices let go of their entries first
+    DX10NoteCache<Sample>* const cache = _cache;
+    for (auto& voice : _voices) detachCache(voice, false);
+    std::memcpy(static_cast<void*>(this), source, sizeof(*this));
+    _cache = cache;
+    return true;
+}
+
+template class BasicDX10Engine<float>;
+template class BasicDX10Engine<double>;
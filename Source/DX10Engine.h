@@ -0,0 +1,414 @@
+#pragma once
+
+#include "DX10Tuning.h"
+#include <cstddef>
+#include <cstdint>
+
+// The DX10 FM synthesis engine on its own: voices, envelopes, MIDI note and
+// controller handling and the render loop. Plain C++ with no JUCE dependency,
+// so it can be built into any host; DX10AudioProcessor is a thin wrapper
+// that feeds it parameters and MIDI.
+//
+// Output depends only on the parameters and on when, in samples since
+// prepare(), each event arrives: how the timeline is split into render()
+// calls makes no difference, bit for bit.
+//
+// The engine is a template on the sample type of its state and output;
+// DX10Engine.cpp instantiates it for float and double.
+
+const int NPARAMS = 16;       // number of FM parameters
+const int NVOICES = 8;        // max polyphony
+const int NCHANNELS = 16;     // MIDI channels
+const int NPOOLVOICES = 32;   // max polyphony in multi-timbral mode, shared by all channels
+const int NUNISON = 4;        // max unison voices per note
+const int NSNAPSHOTPARAMS = NPARAMS + 8;  // FM parameters plus Gain, Saturation, Glide, the stereo / unison settings and LFO Mode
+
+const float SILENCE = 0.0003f;  // voice choking
+
+template <typename Sample> class DX10NoteCache;
+
+// State for an active voice.
+template <typename Sample>
+struct Voice
+{
+    // What note triggered this voice, or SUSTAIN when the key is released
+    // but the sustain pedal is still held down. 0 if the voice is inactive.
+    int note;
+
+    // MIDI channel that played the note (always 0 unless multi-timbral) and
+    // the patch it sounds with.
+    int channel;
+    int patch;
+
+    // Carrier phase increment, before pitch bend and unison detune
+    Sample dcar;
+
+    // Target phase increment for glide
+    Sample dcarTarget;  // target phase increment (for portamento/glide)
+    Sample dcarGlide;   // glide rate (0 = instant, closer to 1 = slower glide)
+
+    // Unison: the note is played by numLanes detuned copies of the carrier
+    // and modulator oscillators. Per-lane state is kept in parallel arrays so
+    // a voice renders all of its lanes in one tight inner loop, sharing the
+    // envelopes below.
+    int numLanes;
+    Sample detune[NUNISON];     // pitch factor of each lane
+    Sample panLeft[NUNISON];    // stereo gains of each lane
+    Sample panRight[NUNISON];
+
+    // Carrier oscillators: phase in fixed point, the whole 32-bit range being
+    // one cycle (-1 to 1 read as signed), so it wraps by itself
+    std::uint32_t car[NUNISON];
+
+    // Modulator sine oscillators
+    Sample modPitch;        // modulator pitch the dmod values were computed for
+    Sample dmod[NUNISON];   // phase increment
+    Sample mod0[NUNISON];
+    Sample mod1[NUNISON];
+
+    // MPE expression: pitch factor, modulator level factor and waveshaping,
+    // each with the per-sample step that ramps it to the value worked out at
+    // the last control tick
+    Sample noteBend, noteBendStep;
+    Sample pressure, pressureStep;
+    Sample richness, richnessStep;
+
+    // Vibrato added to the carrier phase, and its per-sample step towards
+    // the LFO value worked out at the last control tick
+    Sample modulation, modulationStep;
+
+    // Carrier envelope
+    Sample env;   // current envelope level
+    Sample cenv;  // smoothed envelope that includes the attack portion
+    Sample catt;  // smoothing coefficient for attack
+    Sample cdec;  // decay mutiplier
+
+    // Modulator envelope
+    Sample menv;  // current envelope level
+    Sample mlev;  // target level
+    Sample mdec;  // decay multiplier
+
+    // Note cache entry this voice plays back or records (-1 for none), and
+    // the block and frame of it that are next. While playing back, only env
+    // is kept up to date.
+    int cacheEntry;
+    int cacheBlock;
+    int cacheFrame;
+    bool cacheRecording;
+};
+
+// Normalised (0 - 1) parameter values, in the order of the plugin's
+// parameters. The defaults are the Log Drum preset.
+struct DX10EngineParameters
+{
+    enum Index
+    {
+        attack, decay, release, coarse, fine,
+        modInit, modDecay, modSustain, modRelease, modVelocity,
+        vibrato, octave, fineTune, waveform, modThru, lfoRate,
+        gain, saturation, glide,
+        spread, panMode, unison, detune,
+        lfoMode
+    };
+
+    float values[NSNAPSHOTPARAMS] = {
+        0.000f, 0.300f, 0.500f, 0.320f, 0.000f, 0.467f, 0.079f, 0.158f,
+        0.500f, 0.500f, 0.000f, 0.400f, 0.500f, 0.151f, 0.020f, 0.500f,
+        0.5f, 0.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 0.3f,
+        0.0f
+    };
+
+    float& operator[](int index) { return values[index]; }
+    float operator[](int index) const { return values[index]; }
+};
+
+template <typename Sample>
+class BasicDX10Engine
+{
+public:
+    BasicDX10Engine();
+
+    // Sets the sample rate and silences the engine. Call before rendering.
+    void prepare(double sampleRate);
+
+    // Silences all voices and resets the MIDI controllers.
+    void reset();
+
+    // Envelope and tuning changes apply to notes started afterwards, the
+    // rest from the next rendered sample. In multi-timbral mode this is the
+    // patch of MIDI channel 1 and of every channel without its own.
+    void setParams(const DX10EngineParameters& params);
+
+    // How MIDI channels are used. Switching silences the engine; channel
+    // patches are kept.
+    enum class ChannelMode
+    {
+        // The MIDI channel is ignored and NVOICES voices are used.
+        single,
+
+        // Every MIDI channel has its own controllers and, once
+        // setChannelParams() gives it one, its own patch. All channels draw
+        // from one pool of NPOOLVOICES voices that is rendered in a single pass.
+        multiTimbral,
+
+        // MPE lower zone: channel 1 carries the controllers for every note,
+        // channels 2 - 16 one note each with its own pitch bend (+/-48
+        // semitones), pressure (modulator level) and CC 74 slide (Waveform).
+        // Expression is read at the LFO's control rate and ramped in between.
+        mpe
+    };
+
+    void setChannelMode(ChannelMode mode);
+    ChannelMode getChannelMode() const { return _channelMode; }
+
+    // Gives a channel (1 - 15, zero-based) its own patch, or returns it to
+    // the setParams() one. Gain and Saturation act on the whole mix, so they
+    // always come from setParams().
+    void setChannelParams(int channel, const DX10EngineParameters& params);
+    void clearChannelParams(int channel);
+
+    // Pitch of every MIDI note, for notes started afterwards; sounding notes
+    // keep theirs. Costs one pass over each patch's 128-note table.
+    void setTuning(const DX10Tuning& tuning);
+
+    // Plays notes nothing modulates back from the cache once they have been
+    // rendered, with identical output (see DX10NoteCache). nullptr, the
+    // default, renders everything live. Not part of the saved state, which
+    // holds every voice live; an engine restored from it keeps its own cache.
+    void setNoteCache(DX10NoteCache<Sample>* cache);
+
+    // Queues a MIDI note, controller, pitch bend or (in MPE mode) channel
+    // pressure message for the next render() call, applied sampleOffset
+    // frames into it; other messages are ignored. Returns false if the queue
+    // is full: render up to sampleOffset, then push the event again.
+    bool pushEvent(const std::uint8_t* data, int size, int sampleOffset);
+
+    // Overwrites numSamples frames of outputs[0] and outputs[1] and consumes
+    // the queued events. Events at or past numSamples are applied at the end.
+    void render(Sample* const* outputs, int numSamples);
+
+    int getNumActiveVoices() const { return _numActiveVoices; }
+
+    // True while no voice sounds and no event is queued, so render() would
+    // only write silence.
+    bool isSilent() const { return _numActiveVoices == 0 && _numEvents == 0; }
+
+    // Moves the engine on by numSamples frames without writing them, exactly
+    // as render() would while isSilent(). Only valid then.
+    void skip(int numSamples);
+
+    // Seconds a released note takes to fade to SILENCE with these
+    // parameters, from the loudest note any velocity and CC 7 volume can play.
+    static double getReleaseSeconds(const DX10EngineParameters& params);
+
+    // The complete engine state (voices, LFO, controllers, parameters, queued
+    // events) as plain bytes. An engine restored from it renders exactly what
+    // the original would have, so a long render can be checkpointed and its
+    // time ranges continued elsewhere. Only valid for the build that saved it.
+    static constexpr std::size_t getStateSize() { return sizeof(BasicDX10Engine); }
+    void saveState(void* dest) const;
+    bool restoreState(const void* source, std::size_t size);
+
+private:
+    struct Event
+    {
+        int frame;
+        std::uint8_t status, data1, data2;
+    };
+
+    // The vibrato LFO a voice follows: its channel's, shared by all of the
+    // channel's notes; one of its own that runs freely; or one of its own
+    // restarted by each note.
+    enum class LfoMode
+    {
+        shared,
+        free,
+        keySync
+    };
+
+    // Sound settings worked out from one set of parameter values.
+    struct Patch
+    {
+        DX10EngineParameters params;
+
+        // Tuning: number of octaves up or down.
+        Sample tune;
+
+        // Fine-tuning: between -1.0 and +1.0 semitones (or -100 to +100 cents).
+        Sample fineTune;
+
+        // Pitch factor of the fine-tuning, applied on top of the note pitch table.
+        Sample fineTuneRatio;
+
+        // Carrier phase increment of each note, and the tune, fine-tune and
+        // tuning it was built for.
+        Sample noteIncrement[128];
+        Sample tableTune, tableFineTuneRatio;
+        std::uint32_t tableTuning;
+
+        // Modulator ratio as a multiple of the carrier frequency.
+        Sample ratio;
+
+        // Carrier envelope settings.
+        Sample attack, decay, release;
+
+        // Modulator envelope settings.
+        Sample modInitialLevel, modDecay, modSustain, modRelease;
+
+        // Velocity sensitivity for the modulator envelope (for brightness).
+        Sample velocitySensitivity;
+
+        // The amount of vibrato to apply.
+        Sample vibrato;
+
+        // Amount of waveshaping to add extra harmonics.
+        Sample richness;
+
+        // Raw Waveform parameter, also used to scale the note-on level.
+        Sample waveform;
+
+        // How much to mix the modulator waveform into the final sound by itself.
+        // Normally the modulator is only used to change the carrier, but for some
+        // extra snazz you can make the modulator waveform audible as well.
+        Sample modMix;
+
+        // LFO phase increment per control tick, in the carrier's fixed point,
+        // and whose LFO a voice follows.
+        std::uint32_t lfoInc;
+        LfoMode lfoMode;
+
+        // Output section parameters
+        Sample outputGain;
+        Sample saturation;
+
+        // Stereo and unison settings, applied at note on
+        Sample spread;          // 0 = mono, 1 = full width
+        bool randomPan;        // pan notes at random instead of by key
+        int unison;            // lanes per note
+        Sample detuneAmount;    // detune of the outermost lanes, in semitones
+
+        // Hash of everything above that shapes a note, for the note cache.
+        std::uint64_t voiceHash;
+    };
+
+    // MIDI controller, LFO and MPE expression state of one channel.
+    struct Channel
+    {
+        // Which patch the channel plays: its own, or 0 for the setParams() one.
+        int patch;
+
+        // Status of the damper pedal: 64 = pressed, 0 = released.
+        int sustain;
+
+        // Output gain in linear units. Can be changed by MIDI CC 7.
+        Sample volume;
+
+        // Modulation wheel value. Used to add more vibrato.
+        Sample modWheel;
+
+        // Pitch bend value.
+        Sample pitchBend;
+
+        // Portamento overrides from MIDI CC #5 (-1 = use the Glide knob) and CC #65
+        Sample portamentoTimeCC;
+        bool portamentoOnCC;
+
+        // Last played note for portamento
+        int lastNote;
+
+        // LFO phase, fixed point like the carrier's.
+        std::uint32_t lfoPhase;
+
+        // Mod wheel + vibrato modulation at the last control tick, and the
+        // per-sample step of the ramp to it from the tick before. Voices
+        // following this LFO ramp the same way.
+        Sample modulationAmount;
+        Sample modulationStep;
+
+        // MPE expression of the note on this channel: pitch factor, pressure
+        // and slide (0 - 1, 0.5 leaves the Waveform setting as it is)
+        Sample noteBend;
+        Sample pressure;
+        Sample slide;
+    };
+
+    void updatePatch(Patch& patch);
+    void processEvent(const Event& event);
+    void renderVoices(Sample* out1, Sample* out2, int numFrames);
+    void renderVoice(Voice<Sample>& voice, Sample& left, Sample& right) const;
+    void lfoTick();
+    void updateExpression(Voice<Sample>& voice, bool ramp) const;
+    void updateVoiceLfoRates(int patch);
+    int controlChannel(int channel) const { return _mpe ? 0 : channel; }
+    void noteOn(int channel, int note, int velocity);
+    int countActiveVoices() const;
+    std::uint64_t hashVoiceParams(const DX10EngineParameters& params) const;
+    void startCache(Voice<Sample>& voice, std::uint64_t key);
+    void playCached(Voice<Sample>& voice, Sample& o1, Sample& o2);
+    void resumeFrom(Voice<Sample>& voice, const Voice<Sample>& state);
+    Voice<Sample> playbackState(const Voice<Sample>& voice) const;
+    void detachCache(Voice<Sample>& voice, bool resume);
+    void detachChannel(int channel);
+    void detachPatch(int patch);
+
+    // The current sample rate and 1 / sample rate.
+    Sample _sampleRate, _inverseSampleRate;
+
+    // MIDI events for the next render() call, in arrival order.
+    static const int EVENTBUFFER = 256;
+    Event _events[EVENTBUFFER];
+    int _numEvents = 0;
+
+    // Special "note number" that says this voice is now kept alive by the
+    // sustain pedal being pressed down. As soon as the pedal is released,
+    // this voice will fade out.
+    static const int SUSTAIN = 128;
+
+    // How MIDI channels are used, how many channels have their own
+    // controllers and LFO, and how many voices can play.
+    ChannelMode _channelMode = ChannelMode::single;
+    bool _mpe = false;
+    int _numChannels = 1;
+    int _numVoices = NVOICES;
+
+    // The voice pool; only the first _numVoices are used.
+    Voice<Sample> _voices[NPOOLVOICES] = {};
+
+    // How many voices are currently in use.
+    int _numActiveVoices;
+
+    // The LFOs only update every 100 samples, and voices ramp linearly from
+    // one value to the next. This counter keeps track of when the next
+    // update is. Voices that have gone silent are cleared on the same
+    // ticks, so that also happens at fixed points in the sample stream, and
+    // MPE expression is read on them too.
+    static const int CONTROLPERIOD = 101;  // samples from one tick to the next
+    int _lfoStep;
+
+    // Per-voice LFOs, used by patches whose LFO Mode isn't shared. Kept in
+    // parallel arrays rather than in Voice so one tick steps every voice's
+    // oscillator in a single loop the compiler can vectorise. Every slot
+    // runs whether or not it sounds.
+    std::uint32_t _voiceLfoPhase[NPOOLVOICES];
+    std::uint32_t _voiceLfoInc[NPOOLVOICES];
+
+    // Note pitches; _tuningVersion changes with every setTuning() call.
+    DX10Tuning _tuning;
+    std::uint32_t _tuningVersion = 1;
+
+    // Patch 0 comes from setParams(), patch n from setChannelParams(n).
+    Patch _patches[NCHANNELS] = {};
+
+    Channel _channels[NCHANNELS] = {};
+
+    // Random pan generator. Part of the engine state, so renders stay repeatable.
+    std::uint32_t _panRandom = 1;
+
+    DX10NoteCache<Sample>* _cache = nullptr;
+};
+
+// Float for realtime use; double for offline renders, where the recursive
+// modulator oscillators of long notes keep their precision.
+using DX10Engine = BasicDX10Engine<float>;
+using DX10EngineDouble = BasicDX10Engine<double>;
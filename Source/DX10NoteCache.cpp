@@ -0,0 +1,178 @@
+#include "DX10NoteCache.h"
+
+template <typename Sample>
+void DX10NoteCache<Sample>::setBudget(std::size_t bytes)
+{
+    // Every entry holds at least one block, so there are as many entry slots
+    const std::size_t numBlocks = bytes / sizeof(Block);
+    _budget = bytes;
+    _blocks.assign(numBlocks, Block());
+    _entries.assign(numBlocks, Entry());
+    _blocks.shrink_to_fit();
+    _entries.shrink_to_fit();
+
+    _freeBlock = _freeEntry = -1;
+    for (std::size_t b = numBlocks; b-- > 0;) {
+        _blocks[b].next = _freeBlock;
+        _freeBlock = int(b);
+        _entries[b].newer = _freeEntry;
+        _freeEntry = int(b);
+    }
+    _oldest = _newest = -1;
+
+    std::size_t tableSize = 1;
+    while (tableSize < 2 * numBlocks) tableSize *= 2;
+    _table.assign(numBlocks > 0 ? tableSize : 0, -1);
+    _table.shrink_to_fit();
+    _tableMask = tableSize - 1;
+}
+
+template <typename Sample>
+int DX10NoteCache<Sample>::find(std::uint64_t key) const
+{
+    if (_table.empty()) return -1;
+    for (std::size_t slot = home(key);; slot = (slot + 1) & _tableMask) {
+        const int entry = _table[slot];
+        if (entry < 0) return -1;
+        if (_entries[size_t(entry)].key == key) return entry;
+    }
+}
+
+template <typename Sample>
+int DX10NoteCache<Sample>::create(std::uint64_t key)
+{
+    // No free slot: reuse the least recently used entry nobody is playing
+    if (_freeEntry < 0) {
+        if (_oldest < 0) return -1;
+        evict(_oldest);
+    }
+    const int entry = _freeEntry;
+    Entry& E = _entries[size_t(entry)];
+    _freeEntry = E.newer;
+
+    E.used = true;
+    E.key = key;
+    E.firstBlock = E.lastBlock = -1;
+    E.numFrames = 0;
+    E.users = 0;
+    E.recording = false;
+    E.complete = false;
+    link(entry);
+
+    std::size_t slot = home(key);
+    while (_table[slot] >= 0) slot = (slot + 1) & _tableMask;
+    _table[slot] = entry;
+    return entry;
+}
+
+template <typename Sample>
+bool DX10NoteCache<Sample>::prepareFrame(int entry, const Voice<Sample>& state)
+{
+    Entry& E = _entries[size_t(entry)];
+    if (E.numFrames % BLOCKFRAMES != 0)
+        return true;
+    if (E.numFrames / BLOCKFRAMES >= MAXENTRYBLOCKS)
+        return false;
+
+    const int block = allocateBlock();
+    if (block < 0)
+        return false;
+    _blocks[size_t(block)].start = state;
+    _blocks[size_t(block)].next = -1;
+    if (E.lastBlock >= 0)
+        _blocks[size_t(E.lastBlock)].next = block;
+    else
+        E.firstBlock = block;
+    E.lastBlock = block;
+    return true;
+}
+
+template <typename Sample>
+void DX10NoteCache<Sample>::finishRecording(int entry, const Voice<Sample>& end, bool complete)
+{
+    Entry& E = _entries[size_t(entry)];
+    E.recording = false;
+    E.end = end;
+    E.complete = complete || E.numFrames >= MAXENTRYBLOCKS * BLOCKFRAMES;
+    release(entry);
+}
+
+template <typename Sample>
+int DX10NoteCache<Sample>::allocateBlock()
+{
+    // Out of blocks: evict least recently used entries nobody is playing.
+    // Those all have blocks, as empty ones are evicted once unused.
+    while (_freeBlock < 0) {
+        if (_oldest < 0) return -1;
+        evict(_oldest);
+    }
+    const int block = _freeBlock;
+    _freeBlock = _blocks[size_t(block)].next;
+    return block;
+}
+
+template <typename Sample>
+void DX10NoteCache<Sample>::unused(int entry)
+{
+    // The entry is now the newest one eviction may take, and goes straight
+    // away if nothing was recorded into it
+    link(entry);
+    if (_entries[size_t(entry)].numFrames == 0)
+        evict(entry);
+}
+
+template <typename Sample>
+void DX10NoteCache<Sample>::evict(int entry)
+{
+    Entry& E = _entries[size_t(entry)];
+    for (int block = E.firstBlock; block >= 0;) {
+        const int next = _blocks[size_t(block)].next;
+        _blocks[size_t(block)].next = _freeBlock;
+        _freeBlock = block;
+        block = next;
+    }
+    E.used = false;
+    E.firstBlock = E.lastBlock = -1;
+    E.numFrames = 0;
+
+    // Take the key out of the table, moving later entries of its probe run
+    // back so no lookup stops early at the gap
+    std::size_t gap = home(E.key);
+    while (_table[gap] != entry) gap = (gap + 1) & _tableMask;
+    for (std::size_t slot = (gap + 1) & _tableMask; _table[slot] >= 0; slot = (slot + 1) & _tableMask) {
+        const std::size_t want = home(_entries[size_t(_table[slot])].key);
+        if (((slot - want) & _tableMask) >= ((slot - gap) & _tableMask)) {
+            _table[gap] = _table[slot];
+            gap = slot;
+        }
+    }
+    _table[gap] = -1;
+
+    unlink(entry);
+    E.newer = _freeEntry;
+    _freeEntry = entry;
+}
+
+template <typename Sample>
+void DX10NoteCache<Sample>::link(int entry)
+{
+    Entry& E = _entries[size_t(entry)];
+    E.older = _newest;
+    E.newer = -1;
+    if (_newest >= 0) _entries[size_t(_newest)].newer = entry;
+    else _oldest = entry;
+    _newest = entry;
+}
+
+template <typename Sample>
+void DX10NoteCache<Sample>::unlink(int entry)
+{
+    Entry& E = _entries[size_t(entry)];
+    if (E.older >= 0) _entries[size_t(E.older)].newer = E.newer;
+    else _oldest = E.newer;
+    if (E.newer >= 0) _entries[size_t(E.newer)].older = E.older;
+    else _newest = E.older;
+}
+
+template class DX10NoteCache<float>;
+template class DX10NoteCache<double>;
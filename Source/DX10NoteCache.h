@@ -0,0 +1,114 @@
+#pragma once
+
+#include "DX10Engine.h"
+#include <cstdint>
+#include <vector>
+
+// Renders of whole notes, for DX10Engine::setNoteCache(). Plain C++ with no
+// JUCE dependency, like the engine.
+//
+// A note that nothing modulates (no vibrato, mod wheel, pitch bend, glide,
+// MPE or random pan) always sounds the same for the same patch, key,
+// velocity and channel volume. The first such note records what its voice
+// adds to the mix, sample by sample; later ones play that back instead of
+// synthesising it, bit for bit the same. Every BLOCKFRAMES frames the voice
+// state is kept as well, so a note that is released or starts being
+// modulated can go back to live synthesis from wherever it is.
+//
+// All memory is allocated by setBudget(); the engine only takes blocks from
+// the pool and, once it runs dry, evicts the least recently used notes that
+// no voice is playing. Every operation a note-on does is O(1): entries are
+// found through an open addressing hash table of their keys, and the notes
+// nobody plays are kept in LRU order on an intrusive list.
+template <typename Sample>
+class DX10NoteCache
+{
+public:
+    static const int BLOCKFRAMES = 1024;     // frames per block, and between saved voice states
+    static const int MAXENTRYBLOCKS = 512;   // longest note kept, in blocks
+
+    struct Block
+    {
+        Voice<Sample> start;   // voice state before the first frame
+        Sample left[BLOCKFRAMES], right[BLOCKFRAMES];  // what the voice added to the mix
+        Sample env[BLOCKFRAMES];                       // its envelope level after each frame
+        int next;              // following block, or -1
+    };
+
+    struct Entry
+    {
+        bool used;
+        std::uint64_t key;       // patch, key, velocity and volume hash
+        int older, newer;        // neighbours on the LRU list while users == 0, or on the free list
+        int firstBlock, lastBlock;
+        int numFrames;
+        int users;               // voices playing or recording it; never evicted while > 0
+        bool recording;          // a voice is adding frames to it
+        bool complete;           // the note is over, or as long as entries get
+        Voice<Sample> end;       // voice state after the last frame
+    };
+
+    // Allocates the pool and forgets every note. Call while no engine is
+    // rendering with this cache; 0 frees it.
+    void setBudget(std::size_t bytes);
+    std::size_t getBudget() const { return _budget; }
+
+    // The entry for the key, or -1. It may still be being recorded.
+    int find(std::uint64_t key) const;
+
+    // An empty entry to record a key find() doesn't know into, or -1 if every
+    // entry is in use.
+    int create(std::uint64_t key);
+
+    // Call before recording each frame: at block boundaries this takes a new
+    // block and keeps state in it. Returns false when the entry can't grow.
+    bool prepareFrame(int entry, const Voice<Sample>& state);
+
+    void recordFrame(int entry, Sample left, Sample right, Sample env)
+    {
+        Entry& E = _entries[size_t(entry)];
+        Block& B = _blocks[size_t(E.lastBlock)];
+        const int frame = E.numFrames++ % BLOCKFRAMES;
+        B.left[frame] = left;
+        B.right[frame] = right;
+        B.env[frame] = env;
+    }
+
+    // Ends a recording with the voice state after its last frame and lets
+    // go of the recording voice's hold. Entries that are not complete are
+    // carried on by the next voice that plays to their end.
+    void finishRecording(int entry, const Voice<Sample>& end, bool complete);
+
+    void acquire(int entry)
+    {
+        if (_entries[size_t(entry)].users++ == 0) unlink(entry);
+    }
+
+    void release(int entry)
+    {
+        if (--_entries[size_t(entry)].users == 0) unused(entry);
+    }
+
+    Entry& getEntry(int entry) { return _entries[size_t(entry)]; }
+    const Block& getBlock(int block) const { return _blocks[size_t(block)]; }
+
+private:
+    int allocateBlock();
+    void evict(int entry);
+    void unused(int entry);
+    void link(int entry);
+    void unlink(int entry);
+    std::size_t home(std::uint64_t key) const { return std::size_t(key ^ (key >> 32)) & _tableMask; }
+
+    std::size_t _budget = 0;
+    std::vector<Block> _blocks;
+    std::vector<Entry> _entries;
+    int _freeBlock = -1;         // head of the free block list
+    int _freeEntry = -1;         // head of the free entry list, linked through newer
+    int _oldest = -1, _newest = -1;  // ends of the LRU list
+
+    // Entry index of every used entry by key, linear probing, -1 for empty.
+    // At least twice as many slots as entries keeps probes short.
+    std::vector<int> _table;
+    std::size_t _tableMask = 0;
+};
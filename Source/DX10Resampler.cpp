@@ -0,0 +1,158 @@
+#include "DX10Resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+
+namespace
+{
+    const double pi = 3.14159265358979323846;
+
+    // Taps per phase when upsampling; scaled up by the ratio when decimating
+    const int baseTaps = 64;
+
+    // Kaiser window shape, 80 - 90 dB of stopband attenuation
+    const double kaiserBeta = 8.0;
+
+    // Filter cutoff as a fraction of the lower sample rate: flat to 20 kHz
+    // at 44.1 kHz, and steep enough to be well down by its Nyquist frequency
+    const double cutoffFraction = 0.46;
+
+    // Zeroth order modified Bessel function of the first kind
+    double besselI0(double x)
+    {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 50 && term > 1e-12 * sum; ++k) {
+            const double half = x / (2.0 * k);
+            term *= half * half;
+            sum += term;
+        }
+        return sum;
+    }
+}
+
+template <typename Sample>
+bool DX10Resampler<Sample>::prepare(int inputRate, int outputRate, int maxOutputFrames)
+{
+    if (inputRate <= 0 || outputRate <= 0 || maxOutputFrames <= 0)
+        return false;
+    const int divisor = std::gcd(inputRate, outputRate);
+    const int up = outputRate / divisor;
+    const int down = inputRate / divisor;
+    if (up > MAXPHASES)
+        return false;
+
+    _upFactor = up;
+    _downFactor = down;
+    _numTaps = int(std::ceil(baseTaps * std::max(1.0, double(down) / double(up))));
+    _maxOutputFrames = maxOutputFrames;
+
+    // Windowed sinc at the upsampled rate, with cutoff in cycles per
+    // upsampled sample. Centred on the output frame nearest the middle of its
+    // _numTaps * L taps, so the delay is a whole number of output frames.
+    const int length = _numTaps * up;
+    _latency = (length - 1) / (2 * down);
+    const double centre = double(_latency) * down;
+    const double halfWidth = std::min(centre, length - 1 - centre) + 1.0;
+    const double cutoff = cutoffFraction * std::min(inputRate, outputRate) / (double(inputRate) * up);
+    const double windowScale = 1.0 / besselI0(kaiserBeta);
+    std::vector<double> taps(static_cast<size_t>(length));
+    for (int j = 0; j < length; ++j) {
+        const double x = j - centre;
+        const double sinc = x == 0.0 ? 1.0 : std::sin(2.0 * pi * cutoff * x) / (2.0 * pi * cutoff * x);
+        const double r = x / halfWidth;
+        const double window = besselI0(kaiserBeta * std::sqrt(std::max(0.0, 1.0 - r * r))) * windowScale;
+        taps[size_t(j)] = sinc * window;
+    }
+
+    // Split into phases, each normalised to unity gain at DC so no phase
+    // adds a ripple to constant signals
+    _coefficients.assign(size_t(length), Sample(0));
+    for (int phase = 0; phase < up; ++phase) {
+        double sum = 0.0;
+        for (int k = 0; k < _numTaps; ++k)
+            sum += taps[size_t(phase + k * up)];
+        for (int k = 0; k < _numTaps; ++k)
+            _coefficients[size_t(phase * _numTaps + _numTaps - 1 - k)] = Sample(taps[size_t(phase + k * up)] / sum);
+    }
+
+    const int maxInput = int((std::int64_t(maxOutputFrames) * down) / up) + 2;
+    for (auto& work : _work)
+        work.assign(size_t(_numTaps + maxInput), Sample(0));
+    reset();
+    return true;
+}
+
+template <typename Sample>
+void DX10Resampler<Sample>::reset()
+{
+    for (auto& work : _work)
+        std::fill(work.begin(), work.end(), Sample(0));
+    _inputAhead = 1;
+    _phase = 0;
+}
+
+template <typename Sample>
+int DX10Resampler<Sample>::getInputNeeded(int numOutputFrames) const
+{
+    if (numOutputFrames <= 0)
+        return 0;
+    const auto advance = (std::int64_t(_phase) + std::int64_t(numOutputFrames - 1) * _downFactor) / _upFactor;
+    return std::max(0, _inputAhead + int(advance));
+}
+
+template <typename Sample>
+void DX10Resampler<Sample>::process(Sample* const* outputs, int numOutputFrames)
+{
+    const int numInput = getInputNeeded(numOutputFrames);
+
+    // Position in _work of the newest input frame the next output frame uses
+    int index = _numTaps - 1 + _inputAhead;
+    int phase = _phase;
+    for (int i = 0; i < numOutputFrames; ++i) {
+        const Sample* coefficients = _coefficients.data() + phase * _numTaps;
+        const Sample* left = _work[0].data() + index - _numTaps + 1;
+        const Sample* right = _work[1].data() + index - _numTaps + 1;
+        Sample sumLeft = 0, sumRight = 0;
+        for (int k = 0; k < _numTaps; ++k) {
+            sumLeft += coefficients[k] * left[k];
+            sumRight += coefficients[k] * right[k];
+        }
+        outputs[0][i] = sumLeft;
+        outputs[1][i] = sumRight;
+
+        phase += _downFactor;
+        index += phase / _upFactor;
+        phase %= _upFactor;
+    }
+    _inputAhead = index - (_numTaps - 1 + numInput);
+    _phase = phase;
+
+    // Keep the newest _numTaps frames as the history for the next call
+    for (auto& work : _work)
+        std::copy(work.begin() + numInput, work.begin() + numInput + _numTaps, work.begin());
+}
+
+template <typename Sample>
+bool DX10Resampler<Sample>::isSilent() const
+{
+    for (const auto& work : _work)
+        for (int k = 0; k < _numTaps; ++k)
+            if (work[size_t(k)] != Sample(0)) return false;
+    return true;
+}
+
+template <typename Sample>
+void DX10Resampler<Sample>::skip(int numOutputFrames)
+{
+    // The same position arithmetic as process(), in one step; the history
+    // stays all zeros
+    const int numInput = getInputNeeded(numOutputFrames);
+    const auto position = std::int64_t(_phase) + std::int64_t(numOutputFrames) * _downFactor;
+    _inputAhead += int(position / _upFactor) - numInput;
+    _phase = int(position % _upFactor);
+}
+
+template class DX10Resampler<float>;
+template class DX10Resampler<double>;
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+
+// Stereo sample rate converter, so the engine can render at a fixed internal
+// rate whatever the host's. Plain C++ with no JUCE dependency, like the
+// engine.
+//
+// Polyphase FIR: the ratio is reduced to outputRate / inputRate = L / M, the
+// input is conceptually upsampled by L, lowpass filtered just below the lower
+// of the two Nyquist frequencies and decimated by M. Only the filter taps that
+// meet a real input sample are computed, so each output frame costs one short
+// dot product per channel. The filter is linear phase and about 64 input
+// samples long, which keeps the latency under a millisecond at 48 kHz.
+template <typename Sample>
+class DX10Resampler
+{
+public:
+    // Builds the filter for the two rates, for up to maxOutputFrames per
+    // process() call, and clears the history. Returns false if the reduced
+    // ratio needs more than MAXPHASES filter phases.
+    bool prepare(int inputRate, int outputRate, int maxOutputFrames);
+
+    // Clears the filter history.
+    void reset();
+
+    int getMaxOutputFrames() const { return _maxOutputFrames; }
+
+    // Delay through the filter, in output frames.
+    int getLatency() const { return _latency; }
+
+    // How many input frames the next process() call of numOutputFrames
+    // consumes. Varies from call to call unless the ratio is a whole number.
+    int getInputNeeded(int numOutputFrames) const;
+
+    // Where to write those input frames, for channel 0 or 1.
+    Sample* getInput(int channel) { return _work[channel].data() + _numTaps; }
+
+    // Converts the getInputNeeded(numOutputFrames) frames written at
+    // getInput() into numOutputFrames frames of outputs[0] and outputs[1].
+    void process(Sample* const* outputs, int numOutputFrames);
+
+    // True when the filter history is all zeros, so silent input gives
+    // silent output.
+    bool isSilent() const;
+
+    // Moves on by numOutputFrames as process() would with silent input,
+    // consuming the same getInputNeeded(numOutputFrames) frames, without
+    // computing anything. Only valid while isSilent().
+    void skip(int numOutputFrames);
+
+    static const int MAXPHASES = 1024;
+
+private:
+    int _upFactor = 1, _downFactor = 1;  // L and M
+    int _numTaps = 1;                     // filter taps per phase
+    int _maxOutputFrames = 0;
+    int _latency = 0;
+
+    // Taps of each phase, reversed so they line up with the input in memory.
+    std::vector<Sample> _coefficients;
+
+    // Per channel: the last _numTaps input frames, then room for the next
+    // call's input.
+    std::vector<Sample> _work[2];
+
+    // Input frames still to arrive before the next output frame can be
+    // computed (0 if it already can), and that frame's filter phase.
+    int _inputAhead = 1;
+    int _phase = 0;
+};
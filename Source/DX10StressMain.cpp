@@ -0,0 +1,477 @@
+// Worst-case MIDI stress test for the processor's block loop. Not part of the
+// plugin; CMakeLists.txt builds it and runs it with the build, and as the
+// dx10stress test, and it exits with 1 on a regression.
+//
+// Every configuration floods an engine with randomized dense MIDI - note storms
+// longer than the engine's event queue at a single position, sustain pedal
+// chatter, CC 5 / 65 portamento toggles, pitch bend sweeps, MIDI Tuning
+// Standard note changes and program changes, with rests in between that let
+// the engine fall idle - through DX10BlockRenderer, as
+// DX10AudioProcessor::renderBlock() does, at the host rate or resampled from
+// an internal rate. A second engine plays the same events one at a time
+// through a loop of its own, so its queue never fills and it never skips a
+// block; the engine renders the same output however the timeline is split, so
+// any difference means an event was dropped or applied out of order, or an
+// idle block wasn't silence. The flooded engine's block times are checked
+// against a deadline, a share of the block's real-time length, in CPU time so
+// that other processes on a busy build machine don't count. The slowest 0.1%
+// are left out as the machine's hiccups: note storms come every 40 blocks or
+// so, and a slow one shows in far more blocks than that.
+
+#include "DX10BlockRenderer.h"
+#include "DX10Engine.h"
+#include "DX10NoteCache.h"
+#include "DX10Resampler.h"
+#include "DX10Tuning.h"
+
+#include <algorithm>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using ChannelMode = DX10Engine::ChannelMode;
+
+    const int HOSTRATE = 44100;
+    const int NPROGRAMS = 32;
+
+    struct Config
+    {
+        int blockSize;
+        ChannelMode channelMode;
+        int internalRate;        // 0 renders at the host rate
+        bool doublePrecision;
+        int cacheMegabytes;
+    };
+
+    const Config configs[] = {
+        { 16,   ChannelMode::single,       0,     false, 0 },
+        { 64,   ChannelMode::single,       0,     false, 16 },
+        { 512,  ChannelMode::single,       0,     false, 0 },
+        { 4096, ChannelMode::single,       0,     false, 0 },
+        { 32,   ChannelMode::multiTimbral, 0,     false, 16 },
+        { 256,  ChannelMode::multiTimbral, 0,     false, 0 },
+        { 128,  ChannelMode::mpe,          0,     false, 0 },
+        { 64,   ChannelMode::single,       48000, false, 0 },
+        { 1024, ChannelMode::multiTimbral, 48000, false, 16 },
+        { 256,  ChannelMode::mpe,          96000, false, 0 },
+        { 128,  ChannelMode::multiTimbral, 0,     true,  0 },
+        { 512,  ChannelMode::single,       48000, true,  0 },
+    };
+
+    const char* modeName(ChannelMode mode)
+    {
+        switch (mode) {
+            case ChannelMode::single: return "single";
+            case ChannelMode::multiTimbral: return "multi";
+            case ChannelMode::mpe: return "mpe";
+        }
+        return "?";
+    }
+
+    // Named like juce::MidiMessageMetadata, so DX10BlockRenderer takes a
+    // block's vector of them as it takes a juce::MidiBuffer.
+    struct Event
+    {
+        int samplePosition;
+        int numBytes;
+        std::uint8_t data[12];
+    };
+
+    // One block's MIDI in time order, as the host would send it.
+    class EventGenerator
+    {
+    public:
+        EventGenerator(unsigned seed, ChannelMode mode) : _rng(seed), _mode(mode) {}
+
+        void makeBlock(int blockSize, std::vector<Event>& events)
+        {
+            events.clear();
+
+            // A rest every few seconds: pedal up, all notes off on every
+            // channel, then blocks without MIDI for long enough to fall silent
+            if (_restFrames > 0) {
+                _restFrames -= blockSize;
+                return;
+            }
+            _framesToRest -= blockSize;
+            if (_framesToRest <= 0) {
+                for (int channel = 0; channel < 16; ++channel) {
+                    add(events, 0, 0xB0 | channel, 64, 0);
+                    add(events, 0, 0xB0 | channel, 123, 0);
+                }
+                _restFrames = HOSTRATE + random(HOSTRATE);
+                _framesToRest = 2 * HOSTRATE + random(2 * HOSTRATE);
+                ++numRests;
+                return;
+            }
+
+            // Note storm: more note ons and offs at one position than the engine queues
+            if (chance(40)) {
+                const int position = random(blockSize);
+                const int count = 300 + random(300);
+                for (int i = 0; i < count; ++i)
+                    add(events, position, (i % 2 == 0 ? 0x90 : 0x80) | noteChannel(), 24 + random(80), 1 + random(127));
+            }
+
+            // Ordinary playing
+            for (int i = random(8); i > 0; --i)
+                add(events, random(blockSize), (chance(2) ? 0x90 : 0x80) | noteChannel(), 36 + random(48), 1 + random(127));
+
+            // Sustain pedal chatter
+            if (chance(3)) {
+                for (int i = 1 + random(6); i > 0; --i)
+                    add(events, random(blockSize), 0xB0 | controlChannel(), 64, chance(2) ? 127 : 0);
+            }
+
+            // Portamento time and on / off
+            if (chance(6)) add(events, random(blockSize), 0xB0 | controlChannel(), 5, random(128));
+            if (chance(6)) add(events, random(blockSize), 0xB0 | controlChannel(), 65, chance(2) ? 127 : 0);
+
+            // Pitch bend sweep across the block
+            if (chance(4)) {
+                const int channel = _mode == ChannelMode::mpe ? noteChannel() : controlChannel();
+                const int count = 1 + random(32);
+                for (int i = 0; i < count; ++i) {
+                    _bend = (_bend + 517) & 0x3FFF;
+                    add(events, i * blockSize / count, 0xE0 | channel, _bend & 0x7F, _bend >> 7);
+                }
+            }
+
+            // MPE expression
+            if (_mode == ChannelMode::mpe && chance(3)) {
+                add(events, random(blockSize), 0xD0 | noteChannel(), random(128), 0);
+                add(events, random(blockSize), 0xB0 | noteChannel(), 74, random(128));
+            }
+
+            // Single note tuning change, real-time, to within a few semitones
+            if (chance(20)) {
+                const int note = random(128);
+                const int semitone = std::min(std::max(note - 2 + random(5), 0), 127);
+                const std::uint8_t tuning[] = { 0xF0, 0x7F, 0x7F, 0x08, 0x02, 0x00, 0x01, std::uint8_t(note),
+                                                std::uint8_t(semitone), std::uint8_t(random(128)), std::uint8_t(random(128)), 0xF7 };
+                Event event { random(blockSize), int(sizeof(tuning)), {} };
+                std::memcpy(event.data, tuning, sizeof(tuning));
+                events.push_back(event);
+            }
+
+            if (chance(30)) {
+                Event event { random(blockSize), 2, { std::uint8_t(0xC0 | controlChannel()), std::uint8_t(random(NPROGRAMS)) } };
+                events.push_back(event);
+            }
+
+            std::stable_sort(events.begin(), events.end(), [](const Event& a, const Event& b) { return a.samplePosition < b.samplePosition; });
+        }
+
+        int numRests = 0;
+
+    private:
+        int random(int range) { return int(_rng() % unsigned(range)); }
+        bool chance(int oneIn) { return random(oneIn) == 0; }
+
+        int noteChannel()
+        {
+            if (_mode == ChannelMode::mpe) return 1 + random(15);
+            return _mode == ChannelMode::multiTimbral ? random(4) : 0;
+        }
+
+        int controlChannel() { return _mode == ChannelMode::multiTimbral ? random(4) : 0; }
+
+        static void add(std::vector<Event>& events, int position, int status, int data1, int data2)
+        {
+            Event event { position, 3, { std::uint8_t(status), std::uint8_t(data1), std::uint8_t(data2) } };
+            events.push_back(event);
+        }
+
+        std::mt19937 _rng;
+        ChannelMode _mode;
+        int _bend = 0x2000;
+        int _framesToRest = HOSTRATE / 2;
+        int _restFrames = 0;
+    };
+
+    // What the two players share: the engine set up for the configuration,
+    // the programs, and DX10AudioProcessor's program change rules.
+    template <typename Sample>
+    class Player
+    {
+    public:
+        Player(const Config& config, const std::vector<DX10EngineParameters>& programs)
+            : _programs(programs)
+        {
+            resampling = config.internalRate > 0 && config.internalRate != HOSTRATE
+                && resampler.prepare(config.internalRate, HOSTRATE, config.blockSize);
+            engine.prepare(resampling ? double(config.internalRate) : double(HOSTRATE));
+            engine.setChannelMode(static_cast<typename BasicDX10Engine<Sample>::ChannelMode>(config.channelMode));
+            engine.setParams(_programs[0]);
+            _multiTimbral = config.channelMode == ChannelMode::multiTimbral;
+            for (int channel = 0; channel < 2; ++channel) {
+                _outputs[channel].resize(std::size_t(config.blockSize));
+                outputs[channel] = _outputs[channel].data();
+            }
+        }
+
+        // The start of a block that isn't skipped, where the processor's
+        // update() hands the engine the parameters of the last main program
+        // change.
+        void update()
+        {
+            if (_publishedProgram >= 0) {
+                engine.setParams(_programs[std::size_t(_publishedProgram)]);
+                _publishedProgram = -1;
+            }
+        }
+
+        // A program change, once everything before it is applied. Channels
+        // past the first switch their own program in multi-timbral mode;
+        // otherwise setCurrentProgram() publishes the program's parameters
+        // for the next block.
+        void programChange(int channel, int program)
+        {
+            if (_multiTimbral && channel > 0) {
+                if (program < NPROGRAMS)
+                    engine.setChannelParams(channel, _programs[std::size_t(program)]);
+            } else {
+                _publishedProgram = program;
+            }
+        }
+
+        BasicDX10Engine<Sample> engine;
+        DX10Resampler<Sample> resampler;
+        DX10Tuning tuning;
+        bool resampling = false;
+        Sample* outputs[2];
+
+    private:
+        const std::vector<DX10EngineParameters>& _programs;
+        bool _multiTimbral = false;
+        int _publishedProgram = -1;
+        std::vector<Sample> _outputs[2];
+    };
+
+    // Plays blocks the way DX10AudioProcessor::renderBlock() does.
+    template <typename Sample>
+    class FloodedPlayer : public Player<Sample>
+    {
+    public:
+        FloodedPlayer(const Config& config, const std::vector<DX10EngineParameters>& programs)
+            : Player<Sample>(config, programs)
+        {
+            _cache.setBudget(std::size_t(config.cacheMegabytes) << 20);
+            this->engine.setNoteCache(config.cacheMegabytes > 0 ? &_cache : nullptr);
+            _renderer.setResampling(this->resampling);
+            _renderer.setMidiTuning(&this->tuning);
+        }
+
+        // Whether the next block is skipped if it has no MIDI.
+        bool isIdle() const { return _renderer.isIdle(); }
+
+        void renderBlock(const std::vector<Event>& events, int numSamples)
+        {
+            if (_renderer.isIdle() && events.empty()) {
+                std::fill(this->outputs[0], this->outputs[0] + numSamples, Sample(0));
+                std::fill(this->outputs[1], this->outputs[1] + numSamples, Sample(0));
+                _renderer.skip(numSamples);
+                ++numSkipped;
+                return;
+            }
+
+            this->update();
+            _renderer.render(this->outputs, numSamples, events,
+                             [this](int channel, int program) { this->programChange(channel, program); });
+        }
+
+        std::int64_t getNumRetries() const { return _renderer.getNumRetries(); }
+        std::int64_t getNumDropped() const { return _renderer.getNumDropped(); }
+
+        long long numSkipped = 0;    // idle blocks
+
+    private:
+        DX10NoteCache<Sample> _cache;
+        DX10BlockRenderer<Sample> _renderer { this->engine, this->resampler };
+    };
+
+    // The oracle: applies every event before it queues the next one, so the
+    // engine's queue never holds more than one, and renders every block. It
+    // has a loop of its own and no note cache, so it shares no mistakes with
+    // DX10BlockRenderer.
+    template <typename Sample>
+    class ReferencePlayer : public Player<Sample>
+    {
+    public:
+        using Player<Sample>::Player;
+
+        // update is false for the blocks the flooded player skips, which
+        // leave the parameters alone.
+        void renderBlock(const std::vector<Event>& events, int numSamples, bool update)
+        {
+            if (update)
+                this->update();
+
+            int frame = 0;
+
+            auto renderTo = [&](int position) {
+                while (frame < position) {
+                    const int numFrames = this->resampling ? std::min(position - frame, this->resampler.getMaxOutputFrames())
+                                                           : position - frame;
+                    Sample* pieceOutputs[2] = { this->outputs[0] + frame, this->outputs[1] + frame };
+                    if (this->resampling) {
+                        Sample* inputs[2] = { this->resampler.getInput(0), this->resampler.getInput(1) };
+                        this->engine.render(inputs, this->resampler.getInputNeeded(numFrames));
+                        this->resampler.process(pieceOutputs, numFrames);
+                    } else {
+                        this->engine.render(pieceOutputs, numFrames);
+                    }
+                    frame += numFrames;
+                }
+            };
+
+            // Applies what is queued without rendering anything
+            auto flush = [&]() {
+                Sample* inputs[2] = { this->resampler.getInput(0), this->resampler.getInput(1) };
+                Sample* pieceOutputs[2] = { this->outputs[0] + frame, this->outputs[1] + frame };
+                this->engine.render(this->resampling ? inputs : pieceOutputs, 0);
+            };
+
+            for (const auto& event : events) {
+                renderTo(std::min(std::max(event.samplePosition, frame), numSamples));
+
+                if (event.numBytes == 2 && (event.data[0] & 0xF0) == 0xC0) {
+                    this->programChange(event.data[0] & 0x0F, event.data[1]);
+                } else if (event.numBytes > 2 && event.data[0] == 0xF0) {
+                    if (this->tuning.applyMidiTuning(event.data + 1, event.numBytes - 2))
+                        this->engine.setTuning(this->tuning);
+                } else {
+                    if (!this->engine.pushEvent(event.data, event.numBytes, event.samplePosition - frame))
+                        ++numRefused;
+                    flush();
+                }
+            }
+
+            renderTo(numSamples);
+        }
+
+        long long numRefused = 0;    // by an empty queue
+    };
+
+    std::vector<DX10EngineParameters> makePrograms(unsigned seed)
+    {
+        // Random FM settings over the default output and stereo settings,
+        // like the factory presets
+        std::mt19937 rng(seed);
+        std::vector<DX10EngineParameters> programs(NPROGRAMS);
+        for (auto& params : programs)
+            for (int i = 0; i < NPARAMS; ++i)
+                params[i] = float(rng() % 1001) * 0.001f;
+        return programs;
+    }
+
+    template <typename Sample>
+    bool runConfig(const Config& config, unsigned seed, double seconds, double deadline)
+    {
+        const auto programs = makePrograms(seed);
+        FloodedPlayer<Sample> flooded(config, programs);
+        ReferencePlayer<Sample> reference(config, programs);
+        EventGenerator generator(seed, config.channelMode);
+        std::vector<Event> events;
+
+        const long long numBlocks = std::max(1LL, static_cast<long long>(seconds * HOSTRATE / config.blockSize));
+        const double blockSeconds = double(config.blockSize) / HOSTRATE;
+        std::vector<double> blockTimes;
+        blockTimes.reserve(std::size_t(numBlocks));
+        double totalSeconds = 0.0;
+        long long numEvents = 0, firstMismatch = -1;
+        int mostVoices = 0;
+
+        for (long long block = 0; block < numBlocks; ++block) {
+            generator.makeBlock(config.blockSize, events);
+            numEvents += static_cast<long long>(events.size());
+            const bool skipping = flooded.isIdle() && events.empty();
+
+            const std::clock_t start = std::clock();
+            flooded.renderBlock(events, config.blockSize);
+            const double blockTime = double(std::clock() - start) / CLOCKS_PER_SEC;
+            blockTimes.push_back(blockTime);
+            totalSeconds += blockTime;
+
+            reference.renderBlock(events, config.blockSize, !skipping);
+            mostVoices = std::max(mostVoices, flooded.engine.getNumActiveVoices());
+
+            const std::size_t bytes = std::size_t(config.blockSize) * sizeof(Sample);
+            if (firstMismatch < 0 && (std::memcmp(flooded.outputs[0], reference.outputs[0], bytes) != 0
+                                      || std::memcmp(flooded.outputs[1], reference.outputs[1], bytes) != 0))
+                firstMismatch = block;
+        }
+
+        // Every rest should end with idle blocks, or the skip went untested
+        const bool eventsOk = flooded.getNumDropped() == 0 && reference.numRefused == 0;
+        const bool outputOk = firstMismatch < 0;
+        const bool idleOk = generator.numRests == 0 || flooded.numSkipped > 0;
+        const auto slowest = blockTimes.end() - 1 - numBlocks / 1000;
+        std::nth_element(blockTimes.begin(), slowest, blockTimes.end());
+        const double worstSeconds = *slowest;
+        const bool timeOk = worstSeconds <= deadline * blockSeconds;
+
+        std::printf("%5d frames %-6s %-8s %-6s cache %2d MB: %lld events, %lld retries, %lld dropped, %lld idle blocks, %d voices, mean block %.3f, 99.9%% %.3f of %.3f ms",
+                    config.blockSize, modeName(config.channelMode),
+                    config.internalRate > 0 ? (std::to_string(config.internalRate) + " Hz").c_str() : "host",
+                    config.doublePrecision ? "double" : "float", config.cacheMegabytes,
+                    numEvents, static_cast<long long>(flooded.getNumRetries()), static_cast<long long>(flooded.getNumDropped()),
+                    flooded.numSkipped, mostVoices,
+                    totalSeconds / double(numBlocks) * 1000.0, worstSeconds * 1000.0, deadline * blockSeconds * 1000.0);
+        if (!outputOk) std::printf("  OUTPUT DIFFERS from block %lld", firstMismatch);
+        if (!eventsOk) std::printf("  EVENTS LOST");
+        if (!idleOk) std::printf("  NEVER IDLE");
+        if (!timeOk) std::printf("  TOO SLOW");
+        std::printf("\n");
+        return eventsOk && outputOk && idleOk && timeOk;
+    }
+
+    void printUsage()
+    {
+        std::printf("usage: dx10stress [options]\n"
+                    "  --seconds S             audio rendered per configuration (default 10)\n"
+                    "  --seed N                random seed (default 1)\n"
+                    "  --deadline F            slowest block allowed (but for 0.1%), as a share of its length (default 1)\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    double seconds = 10.0;
+    unsigned seed = 1;
+    double deadline = 1.0;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string option = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : "";
+
+        ++i;
+        if (option == "--seconds") seconds = std::atof(value);
+        else if (option == "--seed") seed = unsigned(std::strtoul(value, nullptr, 10));
+        else if (option == "--deadline") deadline = std::atof(value);
+        else {
+            std::fprintf(stderr, "bad option: %s %s\n", option.c_str(), value);
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (seconds <= 0.0 || deadline <= 0.0) {
+        printUsage();
+        return 1;
+    }
+
+    bool ok = true;
+    for (const auto& config : configs)
+        ok = (config.doublePrecision ? runConfig<double>(config, seed, seconds, deadline)
+                                     : runConfig<float>(config, seed, seconds, deadline)) && ok;
+
+    std::printf(ok ? "all passed\n" : "FAILED\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+// Trace scope for the hot paths of the JUCE-free code. Off by default, so the
+// engine builds without JUCE; the plugin sets DX10_ENGINE_TRACING and gets
+// them in its traces next to the processor's own scopes.
+#ifndef DX10_ENGINE_TRACE_SCOPE
+ #if DX10_ENGINE_TRACING
+  #include "TraceRecorder.h"
+  #define DX10_ENGINE_TRACE_SCOPE(name) DX10_TRACE_SCOPE(name)
+ #else
+  #define DX10_ENGINE_TRACE_SCOPE(name)
+ #endif
+#endif
@@ -0,0 +1,176 @@
+#include "DX10Tuning.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    const double noteZeroHz = 8.175798915644;
+
+    // Non-comment lines of a Scala file, trimmed
+    std::vector<std::string> readLines(const std::string& text)
+    {
+        std::vector<std::string> lines;
+        std::istringstream stream(text);
+        for (std::string line; std::getline(stream, line);) {
+            if (!line.empty() && line[0] == '!')
+                continue;
+            const auto first = line.find_first_not_of(" \t\r");
+            const auto last = line.find_last_not_of(" \t\r");
+            lines.push_back(first == std::string::npos ? std::string() : line.substr(first, last - first + 1));
+        }
+        return lines;
+    }
+
+    // A scale degree: cents if it has a period, otherwise a ratio n/d or n
+    bool parsePitch(const std::string& line, double& cents)
+    {
+        const std::string value = line.substr(0, line.find_first_of(" \t"));
+        if (value.empty())
+            return false;
+        char* end = nullptr;
+        if (value.find('.') != std::string::npos) {
+            cents = std::strtod(value.c_str(), &end);
+            return *end == '\0';
+        }
+        const double numerator = std::strtod(value.c_str(), &end);
+        double denominator = 1.0;
+        if (*end == '/')
+            denominator = std::strtod(end + 1, &end);
+        if (*end != '\0' || numerator <= 0.0 || denominator <= 0.0)
+            return false;
+        cents = 1200.0 * std::log2(numerator / denominator);
+        return true;
+    }
+
+    // MTS frequency: semitone, then a 14-bit fraction of a semitone
+    float midiTuningPitch(const std::uint8_t* bytes)
+    {
+        const double semitones = bytes[0] + (bytes[1] * 128 + bytes[2]) / 16384.0;
+        return float(std::exp2(semitones / 12.0));
+    }
+}
+
+DX10Tuning::DX10Tuning()
+{
+    for (int note = 0; note < 128; ++note)
+        pitch[note] = std::exp(0.05776226505f * float(note));
+}
+
+void DX10Tuning::setFrequencies(const double* frequencies)
+{
+    for (int note = 0; note < 128; ++note)
+        pitch[note] = float(frequencies[note] / noteZeroHz);
+}
+
+bool DX10Tuning::loadScala(const std::string& scale, const std::string& mapping, std::string& error)
+{
+    // Scale: description, degree count, then the degrees; the last one is the period
+    const auto scl = readLines(scale);
+    const int numDegrees = scl.size() >= 2 ? std::atoi(scl[1].c_str()) : 0;
+    if (numDegrees < 1 || scl.size() < size_t(2 + numDegrees)) {
+        error = "The scale has no pitches";
+        return false;
+    }
+    std::vector<double> cents(size_t(numDegrees) + 1, 0.0);
+    for (int degree = 1; degree <= numDegrees; ++degree) {
+        if (!parsePitch(scl[size_t(1 + degree)], cents[size_t(degree)])) {
+            error = "Bad pitch in the scale: " + scl[size_t(1 + degree)];
+            return false;
+        }
+    }
+    const double period = cents[size_t(numDegrees)];
+
+    // Mapping: size, first and last note, middle note, reference note and
+    // frequency, formal octave degree, then one degree (or x) per key
+    int mapSize = 0, firstNote = 0, lastNote = 127, middleNote = 60, referenceNote = 60, octaveDegree = numDegrees;
+    double referenceHz = 261.625565300599;
+    std::vector<int> keys;
+    if (mapping.find_first_not_of(" \t\r\n") != std::string::npos) {
+        std::vector<std::string> kbm;
+        for (const auto& line : readLines(mapping))
+            if (!line.empty()) kbm.push_back(line);
+        if (kbm.size() < 7) {
+            error = "The keyboard mapping is incomplete";
+            return false;
+        }
+        mapSize = std::atoi(kbm[0].c_str());
+        firstNote = std::atoi(kbm[1].c_str());
+        lastNote = std::atoi(kbm[2].c_str());
+        middleNote = std::atoi(kbm[3].c_str());
+        referenceNote = std::atoi(kbm[4].c_str());
+        referenceHz = std::atof(kbm[5].c_str());
+        octaveDegree = std::atoi(kbm[6].c_str());
+        if (mapSize < 0 || referenceHz <= 0.0 || referenceNote < 0 || referenceNote > 127 || octaveDegree < 0) {
+            error = "Bad keyboard mapping header";
+            return false;
+        }
+        for (int key = 0; key < mapSize; ++key) {
+            const size_t line = size_t(7 + key);
+            keys.push_back(line < kbm.size() && kbm[line][0] != 'x' ? std::atoi(kbm[line].c_str()) : -1);
+        }
+        if (mapSize == 0)
+            octaveDegree = numDegrees;
+    }
+
+    // Cents of any scale degree, counting whole periods
+    auto degreeCents = [&](int degree) {
+        const int octave = int(std::floor(double(degree) / numDegrees));
+        return octave * period + cents[size_t(degree - octave * numDegrees)];
+    };
+
+    // Cents of each note above the middle note, or NAN for unmapped keys
+    double noteCents[128];
+    for (int note = 0; note < 128; ++note) {
+        const int steps = note - middleNote;
+        if (note < firstNote || note > lastNote) {
+            noteCents[note] = NAN;
+        } else if (mapSize == 0) {
+            noteCents[note] = degreeCents(steps);
+        } else {
+            const int octave = int(std::floor(double(steps) / mapSize));
+            const int key = keys[size_t(steps - octave * mapSize)];
+            noteCents[note] = key < 0 ? NAN : octave * degreeCents(octaveDegree) + degreeCents(key);
+        }
+    }
+
+    if (std::isnan(noteCents[referenceNote])) {
+        error = "The reference note is not mapped";
+        return false;
+    }
+    for (int note = 0; note < 128; ++note) {
+        pitch[note] = std::isnan(noteCents[note]) ? 0.0f
+            : float(referenceHz / noteZeroHz * std::exp2((noteCents[note] - noteCents[referenceNote]) / 1200.0));
+    }
+    return true;
+}
+
+bool DX10Tuning::applyMidiTuning(const std::uint8_t* data, int size)
+{
+    // 7E (non-real-time) or 7F (real-time), device ID, 08 = MIDI Tuning
+    if (size < 4 || (data[0] != 0x7E && data[0] != 0x7F) || data[2] != 0x08)
+        return false;
+
+    if (data[3] == 0x01 && size >= 5 + 16 + 128 * 3) {
+        // Bulk dump: program, 16 name bytes, then every note's frequency
+        const std::uint8_t* entry = data + 5 + 16;
+        for (int note = 0; note < 128; ++note, entry += 3) {
+            if (entry[0] != 0x7F || entry[1] != 0x7F || entry[2] != 0x7F)  // 7F 7F 7F = no change
+                pitch[note] = midiTuningPitch(entry);
+        }
+        return true;
+    }
+
+    if (data[3] == 0x02 && size >= 6) {
+        // Single note tuning change: program, count, then note + frequency
+        const int count = data[5];
+        for (int i = 0; i < count && 6 + 4 * i + 4 <= size; ++i) {
+            const std::uint8_t* entry = data + 6 + 4 * i;
+            pitch[entry[0] & 0x7F] = midiTuningPitch(entry + 1);
+        }
+        return true;
+    }
+    return false;
+}
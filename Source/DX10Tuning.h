@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// The pitch of every MIDI note, for DX10Engine::setTuning(). Plain C++ with
+// no JUCE dependency, like the engine. Pitches are relative to 8.1758 Hz
+// (12-TET MIDI note 0), so the default table is the engine's usual tuning.
+struct DX10Tuning
+{
+    float pitch[128];
+
+    // 12-tone equal temperament
+    DX10Tuning();
+
+    // Sets the pitch of every note from frequencies in Hz, for example as
+    // reported by an MTS-ESP master.
+    void setFrequencies(const double* frequencies);
+
+    // Loads a Scala scale (.scl file contents) with an optional keyboard
+    // mapping (.kbm contents, empty for the default: middle C on scale
+    // degree 0 at 261.63 Hz). Unmapped keys get pitch 0 and stay silent. On
+    // failure the tuning is unchanged and error says why.
+    bool loadScala(const std::string& scale, const std::string& mapping, std::string& error);
+
+    // Applies a MIDI Tuning Standard message (bulk tuning dump or single note
+    // tuning change, real-time or not), data without the F0 / F7 bytes.
+    // Returns false if the message is something else.
+    bool applyMidiTuning(const std::uint8_t* data, int size);
+};
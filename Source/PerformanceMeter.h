@@ -0,0 +1,130 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include <vector>
+
+// Live DSP load and voice meter. Drains the processor's block telemetry on
+// the message thread and keeps the most recent blocks for CSV export.
+class PerformanceMeter : public juce::Component,
+                         private juce::Timer
+{
+public:
+    static constexpr size_t historySize = 16384;  // blocks kept for export
+
+    explicit PerformanceMeter(DX10AudioProcessor& p) : processor(p)
+    {
+        history.resize(historySize);
+        presets.resize(historySize);
+        startTimerHz(15);
+    }
+
+    ~PerformanceMeter() override
+    {
+        stopTimer();
+    }
+
+    void paint(juce::Graphics& g) override
+    {
+        auto bounds = getLocalBounds().toFloat();
+        auto bar = bounds.removeFromLeft(bounds.getWidth() * 0.3f).reduced(0.0f, bounds.getHeight() * 0.25f);
+
+        g.setColour(juce::Colour(0xFF1A1A22));
+        g.fillRoundedRectangle(bar, 2.0f);
+
+        // Average load in the bar, peak as a tick
+        g.setColour(averageLoad < 0.5f ? juce::Colour(0xFF00D4AA) : averageLoad < 0.8f ? juce::Colour(0xFFE0B030) : juce::Colour(0xFFE04040));
+        g.fillRoundedRectangle(bar.withWidth(bar.getWidth() * juce::jlimit(0.0f, 1.0f, averageLoad)), 2.0f);
+        g.setColour(juce::Colour(0xFFCCCCCC));
+        g.fillRect(bar.getX() + bar.getWidth() * juce::jlimit(0.0f, 1.0f, peakLoad) - 1.0f, bar.getY(), 2.0f, bar.getHeight());
+
+        auto text = "CPU " + juce::String(averageLoad * 100.0f, 1) + "%  peak " + juce::String(peakLoad * 100.0f, 1)
+                  + "%  worst " + juce::String(processor.getTelemetry().getWorstDurationMs(), 2) + " ms  voices "
+                  + juce::String(voices);
+        if (const int overruns = processor.getTelemetry().getNumOverruns(); overruns > 0)
+            text << "  over deadline " << overruns;
+        if (const int dropped = processor.getTelemetry().getNumDropped(); dropped > 0)
+            text << "  dropped " << dropped;
+
+        g.setFont(10.0f);
+        g.setColour(juce::Colour(0xFF888899));
+        g.drawText(text, bounds.withTrimmedLeft(6.0f), juce::Justification::centredLeft, true);
+    }
+
+    void mouseDoubleClick(const juce::MouseEvent&) override
+    {
+        processor.getTelemetry().resetWorstDuration();
+        repaint();
+    }
+
+    // Writes the kept blocks, oldest first. Returns false if the file could not be written.
+    bool writeCsv(const juce::File& file) const
+    {
+        juce::MemoryOutputStream out;
+        out << "time_s,duration_ms,load_percent,samples,voices,events,preset\n";
+
+        const size_t count = juce::jmin(numRecorded, historySize);
+        const size_t first = (writePosition + historySize - count) % historySize;
+        const auto origin = count > 0 ? history[first].startTicks : 0;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const size_t index = (first + i) % historySize;
+            const auto& stats = history[index];
+            out << juce::String(juce::Time::highResolutionTicksToSeconds(stats.startTicks - origin), 6) << ","
+                << juce::String(stats.durationMs, 4) << ","
+                << juce::String(stats.load * 100.0f, 2) << ","
+                << stats.numSamples << ","
+                << stats.activeVoices << ","
+                << stats.events << ","
+                << "\"" << presets[index].replace("\"", "\"\"") << "\"\n";
+        }
+
+        return file.replaceWithData(out.getData(), out.getDataSize());
+    }
+
+private:
+    void timerCallback() override
+    {
+        BlockStats pending[256];
+        float loadSum = 0.0f, peak = 0.0f;
+        int numRead = 0;
+
+        // Blocks are tagged with the preset active when they are drained
+        const auto preset = processor.getCurrentPresetName();
+
+        for (int n; (n = processor.getTelemetry().read(pending, 256)) > 0;)
+        {
+            for (int i = 0; i < n; ++i)
+            {
+                loadSum += pending[i].load;
+                peak = juce::jmax(peak, pending[i].load);
+                voices = pending[i].activeVoices;
+
+                history[writePosition] = pending[i];
+                presets[writePosition] = preset;
+                writePosition = (writePosition + 1) % historySize;
+                ++numRecorded;
+            }
+            numRead += n;
+        }
+
+        if (numRead > 0)
+        {
+            averageLoad = loadSum / static_cast<float>(numRead);
+            peakLoad = peak;
+            repaint();
+        }
+    }
+
+    DX10AudioProcessor& processor;
+    std::vector<BlockStats> history;
+    std::vector<juce::String> presets;
+    size_t writePosition = 0;
+    size_t numRecorded = 0;
+
+    float averageLoad = 0.0f, peakLoad = 0.0f;
+    int voices = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PerformanceMeter)
+};
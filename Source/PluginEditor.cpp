@@ -1,16 +1,17 @@
 #include "PluginEditor.h"
 
 DX10AudioProcessorEditor::DX10AudioProcessorEditor(DX10AudioProcessor& p)
-    : AudioProcessorEditor(&p), audioProcessor(p)
+    : AudioProcessorEditor(&p), audioProcessor(p), performanceMeter(p)
 {
-    setLookAndFeel(&customLookAndFeel);
+    setLookAndFeel(customLookAndFeel.get());
 
     // Initialize preset manager
-    presetManager = std::make_unique<PresetManager>(audioProcessor.apvts);
+    presetManager = std::make_unique<PresetManager>(audioProcessor);
 
     // Connect spectrum analyzer to processor
     audioProcessor.setSpectrumAnalyzer(&spectrumAnalyzer);
     addAndMakeVisible(spectrumAnalyzer);
+    addAndMakeVisible(performanceMeter);
 
     // Setup knobs
     setupKnob(attackKnob, "ATTACK"); setupKnob(decayKnob, "DECAY"); setupKnob(releaseKnob, "RELEASE");
@@ -19,63 +20,38 @@ DX10AudioProcessorEditor::DX10AudioProcessorEditor(DX10AudioProcessor& p)
     setupKnob(modRelKnob, "RELEASE"); setupKnob(modVelKnob, "VEL SENS");
     setupKnob(octaveKnob, "OCTAVE"); setupKnob(fineTuneKnob, "FINE TUNE");
     setupKnob(vibratoKnob, "VIBRATO"); setupKnob(waveformKnob, "WAVEFORM");
-    setupKnob(modThruKnob, "MOD THRU"); setupKnob(lfoRateKnob, "LFO RATE");
+    setupKnob(modThruKnob, "MOD THRU"); setupKnob(lfoRateKnob, "LFO RATE"); setupKnob(lfoModeKnob, "LFO MODE");
     setupKnob(glideKnob, "GLIDE"); setupKnob(gainKnob, "GAIN"); setupKnob(saturationKnob, "SATURATE");
+    setupKnob(spreadKnob, "SPREAD"); setupKnob(panModeKnob, "PAN MODE");
+    setupKnob(unisonKnob, "UNISON"); setupKnob(detuneKnob, "DETUNE");
 
-    // Create attachments
-    attackAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "Attack", attackKnob.getSlider());
-    decayAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "Decay", decayKnob.getSlider());
-    releaseAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "Release", releaseKnob.getSlider());
-    coarseAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "Coarse", coarseKnob.getSlider());
-    fineAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "Fine", fineKnob.getSlider());
-    modInitAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "Mod Init", modInitKnob.getSlider());
-    modDecAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "Mod Dec", modDecKnob.getSlider());
-    modSusAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "Mod Sus", modSusKnob.getSlider());
-    modRelAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "Mod Rel", modRelKnob.getSlider());
-    modVelAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "Mod Vel", modVelKnob.getSlider());
-    octaveAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "Octave", octaveKnob.getSlider());
-    fineTuneAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "FineTune", fineTuneKnob.getSlider());
-    vibratoAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "Vibrato", vibratoKnob.getSlider());
-    waveformAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "Waveform", waveformKnob.getSlider());
-    modThruAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "Mod Thru", modThruKnob.getSlider());
-    lfoRateAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "LFO Rate", lfoRateKnob.getSlider());
-    gainAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "Gain", gainKnob.getSlider());
-    saturationAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "Saturation", saturationKnob.getSlider());
-    glideAttachment = std::make_unique<SliderAttachment>(audioProcessor.apvts, "Glide", glideKnob.getSlider());
-
-    // Set associated parameters for host context menu (DAW automation)
-    attackKnob.getSlider().setAssociatedParameter(audioProcessor.apvts.getParameter("Attack"));
-    decayKnob.getSlider().setAssociatedParameter(audioProcessor.apvts.getParameter("Decay"));
-    releaseKnob.getSlider().setAssociatedParameter(audioProcessor.apvts.getParameter("Release"));
-    coarseKnob.getSlider().setAssociatedParameter(audioProcessor.apvts.getParameter("Coarse"));
-    fineKnob.getSlider().setAssociatedParameter(audioProcessor.apvts.getParameter("Fine"));
-    modInitKnob.getSlider().setAssociatedParameter(audioProcessor.apvts.getParameter("Mod Init"));
-    modDecKnob.getSlider().setAssociatedParameter(audioProcessor.apvts.getParameter("Mod Dec"));
-    modSusKnob.getSlider().setAssociatedParameter(audioProcessor.apvts.getParameter("Mod Sus"));
-    modRelKnob.getSlider().setAssociatedParameter(audioProcessor.apvts.getParameter("Mod Rel"));
-    modVelKnob.getSlider().setAssociatedParameter(audioProcessor.apvts.getParameter("Mod Vel"));
-    octaveKnob.getSlider().setAssociatedParameter(audioProcessor.apvts.getParameter("Octave"));
-    fineTuneKnob.getSlider().setAssociatedParameter(audioProcessor.apvts.getParameter("FineTune"));
-    vibratoKnob.getSlider().setAssociatedParameter(audioProcessor.apvts.getParameter("Vibrato"));
-    waveformKnob.getSlider().setAssociatedParameter(audioProcessor.apvts.getParameter("Waveform"));
-    modThruKnob.getSlider().setAssociatedParameter(audioProcessor.apvts.getParameter("Mod Thru"));
-    lfoRateKnob.getSlider().setAssociatedParameter(audioProcessor.apvts.getParameter("LFO Rate"));
-    gainKnob.getSlider().setAssociatedParameter(audioProcessor.apvts.getParameter("Gain"));
-    saturationKnob.getSlider().setAssociatedParameter(audioProcessor.apvts.getParameter("Saturation"));
-    glideKnob.getSlider().setAssociatedParameter(audioProcessor.apvts.getParameter("Glide"));
-
-    // Build preset list
+    // Attach knobs straight to the processor's cached parameters, in
+    // snapshot order, so no parameter is looked up by name
+    RotaryKnobWithLabel* knobs[NSNAPSHOTPARAMS] = {
+        &attackKnob, &decayKnob, &releaseKnob, &coarseKnob, &fineKnob, &modInitKnob, &modDecKnob, &modSusKnob,
+        &modRelKnob, &modVelKnob, &vibratoKnob, &octaveKnob, &fineTuneKnob, &waveformKnob, &modThruKnob, &lfoRateKnob,
+        &gainKnob, &saturationKnob, &glideKnob, &spreadKnob, &panModeKnob, &unisonKnob, &detuneKnob,
+        &lfoModeKnob
+    };
+    attachments.reserve(NSNAPSHOTPARAMS);
+    for (int i = 0; i < NSNAPSHOTPARAMS; ++i) {
+        auto* parameter = audioProcessor.getSnapshotParameter(i);
+        attachments.push_back(std::make_unique<juce::SliderParameterAttachment>(*parameter, knobs[i]->getSlider(), &audioProcessor.undoManager));
+        // Set associated parameter for host context menu (DAW automation)
+        knobs[i]->getSlider().setAssociatedParameter(parameter);
+    }
+
+    // Factory presets show straight away; the preset folder is scanned in the
+    // background and kept in sync with the watcher once the scan is done
+    updatePresetList();
     rebuildPresetList();
-    updatePresetSelectorFromParameter();
+    presetWatcher.onChanges = [this](const std::vector<PresetChange>& changes) { handlePresetChanges(changes); };
     
     presetSelector.onChange = [this]() {
         if (isUpdatingPresetSelector) return;
         int selectedId = presetSelector.getSelectedId();
         
-        // Store the selected preset ID in the parameter (for undo tracking)
-        if (auto* param = audioProcessor.apvts.getParameter("SelectedPresetId"))
-            param->setValueNotifyingHost(param->convertTo0to1(static_cast<float>(selectedId)));
-        
+        // The load records the selected preset ID in its own undo step
         if (selectedId > 0 && selectedId <= numFactoryPresets) {
             // Factory preset
             lastLoadedUserPreset = juce::File();  // Clear user preset tracking
@@ -83,17 +59,18 @@ DX10AudioProcessorEditor::DX10AudioProcessorEditor(DX10AudioProcessor& p)
         }
         else if (selectedId > 1000) {
             // User preset - look up file from map
-            auto it = presetIdToFile.find(selectedId);
-            if (it != presetIdToFile.end() && it->second.existsAsFile()) {
-                lastLoadedUserPreset = it->second;  // Track which preset was loaded
+            auto it = presetIdToItem.find(selectedId);
+            if (it != presetIdToItem.end() && presetManager->loadPreset(it->second, selectedId)) {
+                lastLoadedUserPreset = it->second.file;  // Track which preset was loaded
                 // Set the preset name for host display
-                audioProcessor.setCurrentPresetName(it->second.getFileNameWithoutExtension());
-                presetManager->loadPresetFromFile(it->second);
-                // Notify host of program change
-                audioProcessor.updateHostDisplay(juce::AudioProcessor::ChangeDetails().withProgramChanged(true));
+                audioProcessor.setCurrentPresetName(it->second.displayName);
             }
         }
+        
+        // Parse the neighbours in the background so the next step is instant
+        prefetchAround(selectedId);
     };
+    presetSelector.onPopup = [this]() { populatePresetSelector(); };
     addAndMakeVisible(presetSelector);
 
     // Previous preset button
@@ -114,6 +91,20 @@ DX10AudioProcessorEditor::DX10AudioProcessorEditor(DX10AudioProcessor& p)
     settingsButton.onClick = [this]() { showSettingsMenu(); };
     addAndMakeVisible(settingsButton);
 
+    // Search button opens the preset browser over the knobs
+    searchButton.setColour(juce::TextButton::buttonColourId, juce::Colour(0xFF2A2A35));
+    searchButton.setColour(juce::TextButton::textColourOffId, juce::Colour(0xFF00D4AA));
+    searchButton.onClick = [this]() { showPresetBrowser(!presetBrowser.isVisible()); };
+    addAndMakeVisible(searchButton);
+
+    presetBrowser.onPresetChosen = [this](int presetId) {
+        showPresetBrowser(false);
+        selectPreset(presetId);
+    };
+    presetBrowser.onDismiss = [this]() { showPresetBrowser(false); };
+    addChildComponent(presetBrowser);
+    searchIndexer.onIndexReady = [this](std::shared_ptr<const PresetSearchIndex> index) { presetBrowser.setIndex(std::move(index)); };
+
     // Spectrum analyzer always visible
     addAndMakeVisible(spectrumAnalyzer);
 
@@ -138,12 +129,12 @@ DX10AudioProcessorEditor::DX10AudioProcessorEditor(DX10AudioProcessor& p)
         if (auto* param = audioProcessor.apvts.getRawParameterValue("SelectedPresetId")) {
             int presetId = static_cast<int>(param->load());
             isUpdatingPresetSelector = true;
-            presetSelector.setSelectedId(presetId, juce::dontSendNotification);
+            selectPreset(presetId, juce::dontSendNotification);
             // Update lastLoadedUserPreset if it's a user preset
             if (presetId > 1000) {
-                auto it = presetIdToFile.find(presetId);
-                if (it != presetIdToFile.end())
-                    lastLoadedUserPreset = it->second;
+                auto it = presetIdToItem.find(presetId);
+                if (it != presetIdToItem.end())
+                    lastLoadedUserPreset = it->second.file;
             } else {
                 lastLoadedUserPreset = juce::File();
             }
@@ -160,12 +151,12 @@ DX10AudioProcessorEditor::DX10AudioProcessorEditor(DX10AudioProcessor& p)
         if (auto* param = audioProcessor.apvts.getRawParameterValue("SelectedPresetId")) {
             int presetId = static_cast<int>(param->load());
             isUpdatingPresetSelector = true;
-            presetSelector.setSelectedId(presetId, juce::dontSendNotification);
+            selectPreset(presetId, juce::dontSendNotification);
             // Update lastLoadedUserPreset if it's a user preset
             if (presetId > 1000) {
-                auto it = presetIdToFile.find(presetId);
-                if (it != presetIdToFile.end())
-                    lastLoadedUserPreset = it->second;
+                auto it = presetIdToItem.find(presetId);
+                if (it != presetIdToItem.end())
+                    lastLoadedUserPreset = it->second.file;
             } else {
                 lastLoadedUserPreset = juce::File();
             }
@@ -182,6 +173,9 @@ DX10AudioProcessorEditor::DX10AudioProcessorEditor(DX10AudioProcessor& p)
     constrainer.setMaximumSize(1500, 1200);
     setResizable(true, true);
     setSize(750, 600);
+    
+    // Left / right arrow keys step through presets
+    setWantsKeyboardFocus(true);
 }
 
 DX10AudioProcessorEditor::~DX10AudioProcessorEditor()
@@ -201,10 +195,38 @@ void DX10AudioProcessorEditor::showSettingsMenu()
     menu.addItem(3, "Open Preset Folder");
     menu.addSeparator();
     menu.addItem(4, "Refresh Preset List");
+    menu.addSeparator();
+    menu.addItem(5, "Export Presets to Bank...");
+    menu.addItem(6, "Import Bank...");
+    menu.addSeparator();
+    menu.addItem(7, "Export Performance Log (CSV)...");
+    menu.addItem(8, TraceRecorder::getInstance().isRecording() ? "Stop Trace and Save..." : "Start Trace Recording");
+    menu.addSeparator();
+    const auto channelMode = audioProcessor.getChannelMode();
+    menu.addItem(9, "Multi-Timbral (16 MIDI Channels)", true, channelMode == DX10AudioProcessor::ChannelMode::multiTimbral);
+    menu.addItem(10, "MPE", true, channelMode == DX10AudioProcessor::ChannelMode::mpe);
+    menu.addSeparator();
+    menu.addItem(11, "Load Tuning (.scl / .kbm)...");
+    menu.addItem(12, "Use Standard Tuning", audioProcessor.getTuningScale().isNotEmpty() || audioProcessor.getTuningMapping().isNotEmpty());
+    menu.addSeparator();
+    const int internalRate = audioProcessor.getInternalRate();
+    juce::PopupMenu rateMenu;
+    rateMenu.addItem(13, "Host Rate", true, internalRate == 0);
+    rateMenu.addItem(14, "48 kHz", true, internalRate == 48000);
+    rateMenu.addItem(15, "96 kHz", true, internalRate == 96000);
+    menu.addSubMenu("Internal Rate", rateMenu);
+    const int noteCacheSize = audioProcessor.getNoteCacheSize();
+    juce::PopupMenu cacheMenu;
+    cacheMenu.addItem(16, "Off", true, noteCacheSize == 0);
+    cacheMenu.addItem(17, "16 MB", true, noteCacheSize == 16);
+    cacheMenu.addItem(18, "64 MB", true, noteCacheSize == 64);
+    cacheMenu.addItem(19, "256 MB", true, noteCacheSize == 256);
+    menu.addSubMenu("Note Cache", cacheMenu);
     
     menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&settingsButton),
-        [this](int result)
+        [this, channelMode](int result)
         {
+            using ChannelMode = DX10AudioProcessor::ChannelMode;
             switch (result)
             {
                 case 1: selectPresetFolder(); break;
@@ -218,10 +240,163 @@ void DX10AudioProcessorEditor::showSettingsMenu()
                 case 4:
                     rebuildPresetList();
                     break;
+                case 5: exportPresetBank(); break;
+                case 6: importPresetBank(); break;
+                case 7: exportPerformanceLog(); break;
+                case 8: toggleTraceRecording(); break;
+                case 9:
+                    audioProcessor.setChannelMode(channelMode == ChannelMode::multiTimbral ? ChannelMode::single : ChannelMode::multiTimbral);
+                    break;
+                case 10:
+                    audioProcessor.setChannelMode(channelMode == ChannelMode::mpe ? ChannelMode::single : ChannelMode::mpe);
+                    break;
+                case 11: loadTuning(); break;
+                case 12: audioProcessor.setTuning({}, {}); break;
+                case 13: audioProcessor.setInternalRate(0); break;
+                case 14: audioProcessor.setInternalRate(48000); break;
+                case 15: audioProcessor.setInternalRate(96000); break;
+                case 16: audioProcessor.setNoteCacheSize(0); break;
+                case 17: audioProcessor.setNoteCacheSize(16); break;
+                case 18: audioProcessor.setNoteCacheSize(64); break;
+                case 19: audioProcessor.setNoteCacheSize(256); break;
             }
         });
 }
 
+void DX10AudioProcessorEditor::exportPresetBank()
+{
+    auto chooser = std::make_shared<juce::FileChooser>(
+        "Export Presets to Bank",
+        presetManager->getPresetDirectory().getParentDirectory(),
+        "*" + PresetBank::getBankExtension()
+    );
+    
+    chooser->launchAsync(
+        juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles,
+        [this, chooser](const juce::FileChooser& fc)
+        {
+            auto file = fc.getResult();
+            if (file == juce::File{})
+                return;
+            if (!file.hasFileExtension(PresetBank::getBankExtension()))
+                file = file.withFileExtension(PresetBank::getBankExtension());
+            
+            if (presetManager->exportPresetsToBank(file) < 0)
+                juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon,
+                                                       "Export Failed", "Could not write " + file.getFullPathName());
+        });
+}
+
+void DX10AudioProcessorEditor::importPresetBank()
+{
+    auto chooser = std::make_shared<juce::FileChooser>(
+        "Import Bank",
+        presetManager->getPresetDirectory(),
+        "*" + PresetBank::getBankExtension()
+    );
+    
+    chooser->launchAsync(
+        juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+        [this, chooser](const juce::FileChooser& fc)
+        {
+            auto file = fc.getResult();
+            if (!file.existsAsFile())
+                return;
+            
+            // Unpack into a folder named after the bank; the watcher picks up the new files
+            auto destination = presetManager->getPresetDirectory().getChildFile(file.getFileNameWithoutExtension());
+            if (presetManager->importBank(file, destination) < 0)
+                juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon,
+                                                       "Import Failed", file.getFileName() + " is not a valid preset bank");
+        });
+}
+
+void DX10AudioProcessorEditor::loadTuning()
+{
+    auto chooser = std::make_shared<juce::FileChooser>(
+        "Load Tuning",
+        juce::File::getSpecialLocation(juce::File::userDocumentsDirectory),
+        "*.scl;*.kbm"
+    );
+    
+    chooser->launchAsync(
+        juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+        [this, chooser](const juce::FileChooser& fc)
+        {
+            auto file = fc.getResult();
+            if (!file.existsAsFile())
+                return;
+            
+            // A scale keeps the current keyboard mapping, and a mapping the current scale
+            const auto text = file.loadFileAsString();
+            const bool isMapping = file.hasFileExtension(".kbm");
+            const auto error = audioProcessor.setTuning(isMapping ? audioProcessor.getTuningScale() : text,
+                                                        isMapping ? text : audioProcessor.getTuningMapping());
+            if (error.isNotEmpty())
+                juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon,
+                                                       "Tuning Not Loaded", file.getFileName() + ": " + error);
+        });
+}
+
+void DX10AudioProcessorEditor::exportPerformanceLog()
+{
+    auto chooser = std::make_shared<juce::FileChooser>(
+        "Export Performance Log",
+        juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("DX10 Performance.csv"),
+        "*.csv"
+    );
+    
+    chooser->launchAsync(
+        juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles,
+        [this, chooser](const juce::FileChooser& fc)
+        {
+            auto file = fc.getResult();
+            if (file == juce::File{})
+                return;
+            if (!file.hasFileExtension(".csv"))
+                file = file.withFileExtension(".csv");
+            
+            if (!performanceMeter.writeCsv(file))
+                juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon,
+                                                       "Export Failed", "Could not write " + file.getFullPathName());
+        });
+}
+
+void DX10AudioProcessorEditor::toggleTraceRecording()
+{
+    auto& recorder = TraceRecorder::getInstance();
+    if (!recorder.isRecording())
+    {
+        recorder.start();
+        return;
+    }
+    
+    // Stop first so the trace ends here rather than after the file dialog
+    recorder.stop();
+    auto chooser = std::make_shared<juce::FileChooser>(
+        "Save Trace",
+        juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("DX10 Trace.json"),
+        "*.json"
+    );
+    
+    chooser->launchAsync(
+        juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles,
+        [chooser](const juce::FileChooser& fc)
+        {
+            auto file = fc.getResult();
+            if (file == juce::File{})
+                return;
+            if (!file.hasFileExtension(".json"))
+                file = file.withFileExtension(".json");
+            
+            TraceRecorder::getInstance().saveAsync(file, [file](bool written) {
+                if (!written)
+                    juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon,
+                                                           "Trace Failed", "Could not write " + file.getFullPathName());
+            });
+        });
+}
+
 void DX10AudioProcessorEditor::selectPresetFolder()
 {
     auto chooser = std::make_shared<juce::FileChooser>(
@@ -245,18 +420,91 @@ void DX10AudioProcessorEditor::selectPresetFolder()
 
 void DX10AudioProcessorEditor::rebuildPresetList()
 {
+    // Full rescan of the preset folder off the message thread; incremental
+    // changes arrive through the watcher, which restarts once the scan is in
+    presetWatcher.stopWatching();
+    presetManager->rescanPresetDirectoryAsync([this]() {
+        presetWatcher.startWatching(presetManager->getPresetDirectory(), PresetManager::getPresetFileExtensions());
+        updatePresetList();
+    });
+}
+
+void DX10AudioProcessorEditor::updatePresetList()
+{
+    // Keep the IDs of presets that are still present so the selection and the
+    // SelectedPresetId parameter stay valid across incremental updates
+    auto previousIds = std::move(presetKeyToId);
+    presetIdToItem.clear();
+    presetKeyToId.clear();
+    
+    numFactoryPresets = audioProcessor.getNumPresets();
+    userPresets = presetManager->getFlatPresetList();
+    
+    for (const auto& item : userPresets)
+    {
+        auto it = previousIds.find(item.getKey());
+        if (!item.isFolder && it != previousIds.end())
+        {
+            presetIdToItem[it->second] = item;
+            presetKeyToId[item.getKey()] = it->second;
+        }
+    }
+    
+    // Generate unique IDs from file path hashes (1001 - 999999 range) for new presets
+    for (const auto& item : userPresets)
+    {
+        if (!item.isFolder && presetKeyToId.find(item.getKey()) == presetKeyToId.end())
+        {
+            const int presetId = generatePresetId(item.getKey());
+            presetIdToItem[presetId] = item;
+            presetKeyToId[item.getKey()] = presetId;
+        }
+    }
+    
+    // Navigation order follows the list: factory presets, then user presets
+    navigationOrder.clear();
+    navigationPosition.clear();
+    for (int i = 0; i < numFactoryPresets; ++i)
+        navigationOrder.push_back(i + 1);
+    for (const auto& item : userPresets)
+        if (!item.isFolder)
+            navigationOrder.push_back(presetKeyToId[item.getKey()]);
+    for (size_t i = 0; i < navigationOrder.size(); ++i)
+        navigationPosition[navigationOrder[i]] = static_cast<int>(i);
+    
+    // The ComboBox items are only rebuilt when its menu next opens, or when
+    // a preset it doesn't list yet is selected. The preset it shows has to be
+    // right straight away, so a rename or removal of that one rebuilds now.
+    presetSelectorStale = true;
+    const int shownId = presetSelector.getSelectedId();
+    if (shownId > numFactoryPresets)
+    {
+        auto shown = presetIdToItem.find(shownId);
+        if (shown == presetIdToItem.end() || presetSelector.getText().trim() != shown->second.displayName)
+            populatePresetSelector();
+    }
+    
+    updatePresetSelectorFromParameter();
+    prefetchAround(presetSelector.getSelectedId());
+    rebuildSearchIndex();
+}
+
+void DX10AudioProcessorEditor::populatePresetSelector()
+{
+    if (!presetSelectorStale)
+        return;
+    presetSelectorStale = false;
+    
+    const bool wasUpdating = isUpdatingPresetSelector;
+    isUpdatingPresetSelector = true;
+    const int selectedId = presetSelector.getSelectedId();
     presetSelector.clear(juce::dontSendNotification);
-    presetIdToFile.clear();
-    fileToPresetId.clear();
     
     // Add factory presets (IDs 1-32)
-    numFactoryPresets = audioProcessor.getNumPresets();
     for (int i = 0; i < numFactoryPresets; ++i)
         presetSelector.addItem(audioProcessor.getPresetName(i), i + 1);
     
-    // Get user presets with folder structure
-    userPresets = presetManager->getFlatPresetList();
-    
+    // User presets with folder structure
     if (userPresets.size() > 0)
     {
         presetSelector.addSeparator();
@@ -276,27 +524,143 @@ void DX10AudioProcessorEditor::rebuildPresetList()
             else
             {
                 displayName += item.displayName;
-                // Generate unique ID from file path hash (1001 - 999999 range)
-                int presetId = generatePresetIdFromFile(item.file);
-                presetSelector.addItem(displayName, presetId);
-                presetIdToFile[presetId] = item.file;
-                fileToPresetId[item.file.getFullPathName()] = presetId;
+                presetSelector.addItem(displayName, presetKeyToId[item.getKey()]);
             }
         }
     }
+    
+    if (selectedId > 0)
+        presetSelector.setSelectedId(selectedId, juce::dontSendNotification);
+    isUpdatingPresetSelector = wasUpdating;
 }
 
-int DX10AudioProcessorEditor::generatePresetIdFromFile(const juce::File& file)
+void DX10AudioProcessorEditor::selectPreset(int presetId, juce::NotificationType notification)
 {
-    // Generate a hash from the full file path
-    juce::String path = file.getFullPathName();
-    size_t hash = std::hash<std::string>{}(path.toStdString());
+    if (presetSelector.indexOfItemId(presetId) < 0)
+        populatePresetSelector();
+    presetSelector.setSelectedId(presetId, notification);
+}
+
+void DX10AudioProcessorEditor::rebuildSearchIndex()
+{
+    std::vector<PresetSearchDocument> documents;
+    documents.reserve(navigationOrder.size());
+    
+    for (int i = 0; i < numFactoryPresets; ++i)
+    {
+        PresetSearchDocument doc;
+        doc.presetId = i + 1;
+        doc.name = audioProcessor.getPresetName(i);
+        doc.folder = "Factory";
+        documents.push_back(std::move(doc));
+    }
+    
+    // Folder rows come before their contents, so a stack of open folders gives each preset its path
+    juce::StringArray folders;
+    for (const auto& item : userPresets)
+    {
+        if (item.isFolder)
+        {
+            folders.removeRange(item.depth, folders.size() - item.depth);
+            folders.add(item.displayName);
+            continue;
+        }
+        
+        PresetSearchDocument doc;
+        doc.presetId = presetKeyToId[item.getKey()];
+        doc.name = item.displayName;
+        doc.folder = folders.joinIntoString("/", 0, item.depth);
+        if (item.bankIndex >= 0)
+        {
+            if (auto* bank = presetManager->getBank(item.file))
+                doc.tags = bank->getPresetTags(item.bankIndex);
+        }
+        else
+        {
+            doc.tagSource = item.file;  // read by the indexer thread
+        }
+        documents.push_back(std::move(doc));
+    }
+    
+    searchIndexer.rebuild(std::move(documents));
+}
+
+void DX10AudioProcessorEditor::showPresetBrowser(bool shouldShow)
+{
+    presetBrowser.setVisible(shouldShow);
+    searchButton.setToggleState(shouldShow, juce::dontSendNotification);
+    if (shouldShow)
+    {
+        presetBrowser.toFront(false);
+        presetBrowser.focusSearchField();
+    }
+    else
+    {
+        grabKeyboardFocus();
+    }
+}
+
+void DX10AudioProcessorEditor::handlePresetChanges(const std::vector<PresetChange>& changes)
+{
+    // Renamed presets keep their ID so the current selection survives the rename
+    bool renamed = false;
+    for (const auto& change : changes)
+    {
+        if (change.type != PresetChange::Type::renamed)
+            continue;
+        
+        renamed = true;
+        for (auto& entry : presetIdToItem)
+        {
+            auto& item = entry.second;
+            auto oldFile = item.file;
+            if (oldFile != change.oldFile && !oldFile.isAChildOf(change.oldFile))
+                continue;
+            
+            presetKeyToId.erase(item.getKey());
+            item.file = (oldFile == change.oldFile) ? change.file
+                                                    : change.file.getChildFile(oldFile.getRelativePathFrom(change.oldFile));
+            presetKeyToId[item.getKey()] = entry.first;
+            
+            if (oldFile == lastLoadedUserPreset)
+            {
+                lastLoadedUserPreset = item.file;
+                if (item.bankIndex < 0)
+                    audioProcessor.setCurrentPresetName(item.file.getFileNameWithoutExtension());
+            }
+        }
+    }
+    
+    if (presetManager->applyPresetChanges(changes) || renamed)
+        updatePresetList();
+}
+
+void DX10AudioProcessorEditor::indexPresetFile(const juce::File& file)
+{
+    // Saved or dropped files show up straight away; the watcher's later report
+    // of the same file is then a no-op
+    if (presetManager->applyPresetChanges({ PresetChange(PresetChange::Type::added, file) }))
+        updatePresetList();
+}
+
+int DX10AudioProcessorEditor::getPresetIdForFile(const juce::File& file)
+{
+    // Loaded files join the list first, so the load can select them
+    indexPresetFile(file);
+    auto it = presetKeyToId.find(file.getFullPathName());
+    return it != presetKeyToId.end() ? it->second : 0;
+}
+
+int DX10AudioProcessorEditor::generatePresetId(const juce::String& presetKey)
+{
+    // Generate a hash from the full file path (plus bank index for bank entries)
+    size_t hash = std::hash<std::string>{}(presetKey.toStdString());
     
     // Map to range 1001 - 999999 (leaving room for factory presets 1-1000)
     int baseId = 1001 + static_cast<int>(hash % 998999);
     
     // Handle collisions by incrementing
-    while (presetIdToFile.find(baseId) != presetIdToFile.end())
+    while (presetIdToItem.find(baseId) != presetIdToItem.end())
         baseId++;
     
     return baseId;
@@ -304,77 +668,58 @@ int DX10AudioProcessorEditor::generatePresetIdFromFile(const juce::File& file)
 
 void DX10AudioProcessorEditor::goToPreviousPreset()
 {
-    int currentId = presetSelector.getSelectedId();
-    
-    // Build list of all valid preset IDs (factory: 1-32, user: 1001+)
-    std::vector<int> validIds;
-    
-    // Add factory preset IDs
-    for (int i = 0; i < numFactoryPresets; ++i)
-        validIds.push_back(i + 1);
-    
-    // Add user preset IDs from the map
-    for (const auto& pair : presetIdToFile)
-        validIds.push_back(pair.first);
-    
-    // Sort to ensure order
-    std::sort(validIds.begin(), validIds.end());
-    
-    if (validIds.empty()) return;
+    stepPreset(-1);
+}
+
+void DX10AudioProcessorEditor::goToNextPreset()
+{
+    stepPreset(1);
+}
+
+void DX10AudioProcessorEditor::stepPreset(int delta)
+{
+    if (navigationOrder.empty()) return;
     
-    // Find current position
-    auto it = std::find(validIds.begin(), validIds.end(), currentId);
+    const int numPresets = static_cast<int>(navigationOrder.size());
+    auto it = navigationPosition.find(presetSelector.getSelectedId());
     
-    int newId;
-    if (it == validIds.end() || it == validIds.begin()) {
-        // Not found or at beginning - wrap to end
-        newId = validIds.back();
+    int position;
+    if (it == navigationPosition.end()) {
+        // Not found - start from the first (or last, going backwards)
+        position = delta > 0 ? 0 : numPresets - 1;
     } else {
-        // Go to previous
-        newId = *(--it);
+        // Wrap around at either end
+        position = ((it->second + delta) % numPresets + numPresets) % numPresets;
     }
     
-    presetSelector.setSelectedId(newId);
+    selectPreset(navigationOrder[static_cast<size_t>(position)]);
 }
 
-void DX10AudioProcessorEditor::goToNextPreset()
+void DX10AudioProcessorEditor::prefetchAround(int presetId)
 {
-    int currentId = presetSelector.getSelectedId();
-    
-    // Build list of all valid preset IDs (factory: 1-32, user: 1001+)
-    std::vector<int> validIds;
-    
-    // Add factory preset IDs
-    for (int i = 0; i < numFactoryPresets; ++i)
-        validIds.push_back(i + 1);
-    
-    // Add user preset IDs from the map
-    for (const auto& pair : presetIdToFile)
-        validIds.push_back(pair.first);
+    auto it = navigationPosition.find(presetId);
+    if (it == navigationPosition.end()) return;
     
-    // Sort to ensure order
-    std::sort(validIds.begin(), validIds.end());
-    
-    if (validIds.empty()) return;
-    
-    // Find current position
-    auto it = std::find(validIds.begin(), validIds.end(), currentId);
-    
-    int newId;
-    if (it == validIds.end()) {
-        // Not found - go to first
-        newId = validIds.front();
-    } else {
-        ++it;
-        if (it == validIds.end()) {
-            // At end - wrap to beginning
-            newId = validIds.front();
-        } else {
-            newId = *it;
+    // Nearest first, alternating forwards and backwards
+    const int numPresets = static_cast<int>(navigationOrder.size());
+    std::vector<FlatPresetItem> neighbours;
+    for (int distance = 1; distance <= PresetPrefetcher::radius && distance * 2 <= numPresets; ++distance) {
+        for (int direction : { 1, -1 }) {
+            int position = ((it->second + direction * distance) % numPresets + numPresets) % numPresets;
+            auto item = presetIdToItem.find(navigationOrder[static_cast<size_t>(position)]);
+            if (item != presetIdToItem.end())
+                neighbours.push_back(item->second);
         }
     }
-    
-    presetSelector.setSelectedId(newId);
+    presetManager->prefetch(neighbours);
+}
+
+bool DX10AudioProcessorEditor::keyPressed(const juce::KeyPress& key)
+{
+    if (key == juce::KeyPress::leftKey) { goToPreviousPreset(); return true; }
+    if (key == juce::KeyPress::rightKey) { goToNextPreset(); return true; }
+    if (key == juce::KeyPress('f', juce::ModifierKeys::commandModifier, 0)) { showPresetBrowser(true); return true; }
+    return false;
 }
 
 void DX10AudioProcessorEditor::savePresetToFile()
@@ -400,16 +745,15 @@ void DX10AudioProcessorEditor::savePresetToFile()
                     // Set the preset name for host display
                     audioProcessor.setCurrentPresetName(file.getFileNameWithoutExtension());
                     
-                    rebuildPresetList();
+                    indexPresetFile(file);
                     
                     // Look up the preset ID using the file path
-                    auto it = fileToPresetId.find(file.getFullPathName());
-                    if (it != fileToPresetId.end()) {
+                    auto it = presetKeyToId.find(file.getFullPathName());
+                    if (it != presetKeyToId.end()) {
                         int presetId = it->second;
                         isUpdatingPresetSelector = true;
-                        presetSelector.setSelectedId(presetId, juce::dontSendNotification);
-                        if (auto* param = audioProcessor.apvts.getParameter("SelectedPresetId"))
-                            param->setValueNotifyingHost(param->convertTo0to1(static_cast<float>(presetId)));
+                        selectPreset(presetId, juce::dontSendNotification);
+                        audioProcessor.setSelectedPresetId(presetId);
                         isUpdatingPresetSelector = false;
                     }
                     
@@ -435,22 +779,16 @@ void DX10AudioProcessorEditor::loadPresetFromFile()
         {
             auto file = fc.getResult();
             if (file.existsAsFile()) {
-                if (presetManager->loadPresetFromFile(file)) {
+                const int presetId = getPresetIdForFile(file);
+                if (presetManager->loadPresetFromFile(file, presetId)) {
                     lastLoadedUserPreset = file;
                     
                     // Set the preset name for host display
                     audioProcessor.setCurrentPresetName(file.getFileNameWithoutExtension());
                     
-                    rebuildPresetList();
-                    
-                    // Look up the preset ID using the file path
-                    auto it = fileToPresetId.find(file.getFullPathName());
-                    if (it != fileToPresetId.end()) {
-                        int presetId = it->second;
+                    if (presetId > 0) {
                         isUpdatingPresetSelector = true;
-                        presetSelector.setSelectedId(presetId, juce::dontSendNotification);
-                        if (auto* param = audioProcessor.apvts.getParameter("SelectedPresetId"))
-                            param->setValueNotifyingHost(param->convertTo0to1(static_cast<float>(presetId)));
+                        selectPreset(presetId, juce::dontSendNotification);
                         isUpdatingPresetSelector = false;
                     }
                     
@@ -475,12 +813,12 @@ void DX10AudioProcessorEditor::updatePresetSelectorFromParameter()
     if (auto* param = audioProcessor.apvts.getRawParameterValue("SelectedPresetId")) {
         int presetId = static_cast<int>(param->load());
         if (presetId > 0) {
-            presetSelector.setSelectedId(presetId, juce::dontSendNotification);
+            selectPreset(presetId, juce::dontSendNotification);
             // Update lastLoadedUserPreset if it's a user preset
             if (presetId > 1000) {
-                auto it = presetIdToFile.find(presetId);
-                if (it != presetIdToFile.end())
-                    lastLoadedUserPreset = it->second;
+                auto it = presetIdToItem.find(presetId);
+                if (it != presetIdToItem.end())
+                    lastLoadedUserPreset = it->second.file;
             } else {
                 lastLoadedUserPreset = juce::File();
             }
@@ -524,22 +862,17 @@ void DX10AudioProcessorEditor::filesDropped(const juce::StringArray& files, int,
     for (const auto& filePath : files) {
         juce::File file(filePath);
         if (file.hasFileExtension(PresetManager::getPresetExtension())) {
-            if (presetManager->loadPresetFromFile(file)) {
+            const int presetId = getPresetIdForFile(file);
+            if (presetManager->loadPresetFromFile(file, presetId)) {
                 lastLoadedUserPreset = file;
                 
                 // Set the preset name for host display
                 audioProcessor.setCurrentPresetName(file.getFileNameWithoutExtension());
                 
-                rebuildPresetList();
-                
-                // Look up the preset ID and update selector
-                auto it = fileToPresetId.find(file.getFullPathName());
-                if (it != fileToPresetId.end()) {
-                    int presetId = it->second;
+                // Update the selector
+                if (presetId > 0) {
                     isUpdatingPresetSelector = true;
-                    presetSelector.setSelectedId(presetId, juce::dontSendNotification);
-                    if (auto* param = audioProcessor.apvts.getParameter("SelectedPresetId"))
-                        param->setValueNotifyingHost(param->convertTo0to1(static_cast<float>(presetId)));
+                    selectPreset(presetId, juce::dontSendNotification);
                     isUpdatingPresetSelector = false;
                 }
                 
@@ -568,6 +901,7 @@ void DX10AudioProcessorEditor::drawSection(juce::Graphics& g, juce::Rectangle<in
 
 void DX10AudioProcessorEditor::paint(juce::Graphics& g)
 {
+    DX10_TRACE_SCOPE("DX10AudioProcessorEditor::paint");
     auto bounds = getLocalBounds();
     float width = float(bounds.getWidth());
     float height = float(bounds.getHeight());
@@ -624,8 +958,10 @@ void DX10AudioProcessorEditor::paint(juce::Graphics& g)
     drawSection(g, {contentBounds.getX() + sectionWidth + sectionGap, contentBounds.getY(), sectionWidth, topRowHeight}, "MODULATOR RATIO");
     drawSection(g, {contentBounds.getX() + (sectionWidth + sectionGap) * 2, contentBounds.getY(), sectionWidth, topRowHeight}, "TUNING");
     
-    // Row 2 - Modulator Envelope (full width)
-    drawSection(g, {contentBounds.getX(), contentBounds.getY() + topRowHeight + sectionGap, contentBounds.getWidth(), midRowHeight}, "MODULATOR ENVELOPE");
+    // Row 2 - Modulator Envelope and Stereo / Unison
+    int modEnvWidth = (contentBounds.getWidth() - sectionGap) * 5 / 9;
+    drawSection(g, {contentBounds.getX(), contentBounds.getY() + topRowHeight + sectionGap, modEnvWidth, midRowHeight}, "MODULATOR ENVELOPE");
+    drawSection(g, {contentBounds.getX() + modEnvWidth + sectionGap, contentBounds.getY() + topRowHeight + sectionGap, contentBounds.getWidth() - modEnvWidth - sectionGap, midRowHeight}, "STEREO / UNISON");
     
     // Row 3 - Output / LFO (full width)
     drawSection(g, {contentBounds.getX(), contentBounds.getY() + topRowHeight + midRowHeight + sectionGap * 2, contentBounds.getWidth(), bottomRowHeight}, "OUTPUT / LFO");
@@ -657,20 +993,26 @@ void DX10AudioProcessorEditor::resized()
     savePresetButton.setBounds(loadPresetButton.getX() - buttonWidth - 4, headerY, buttonWidth, buttonHeight);
     
     settingsButton.setBounds(savePresetButton.getX() - smallButtonWidth - int(12.0f * scale), headerY, smallButtonWidth, buttonHeight);
+    searchButton.setBounds(settingsButton.getX() - buttonWidth - 4, headerY, buttonWidth, buttonHeight);
     
     // Left side: Preset navigation
     int presetAreaX = margin + int(110.0f * scale);
     prevPresetButton.setBounds(presetAreaX, headerY, smallButtonWidth, buttonHeight);
     
-    int presetSelectorWidth = settingsButton.getX() - prevPresetButton.getRight() - smallButtonWidth - int(16.0f * scale);
+    int presetSelectorWidth = searchButton.getX() - prevPresetButton.getRight() - smallButtonWidth - int(16.0f * scale);
     presetSelector.setBounds(prevPresetButton.getRight() + 2, headerY, presetSelectorWidth, buttonHeight);
     nextPresetButton.setBounds(presetSelector.getRight() + 2, headerY, smallButtonWidth, buttonHeight);
 
+    // Load meter right-aligned under the buttons
+    int meterWidth = int(220.0f * scale);
+    performanceMeter.setBounds(rightEdge - meterWidth, headerY + buttonHeight + int(6.0f * scale), meterWidth, int(14.0f * scale));
+
     // Spectrum toggle button (bottom left, just above where spectrum would be)
     int spectrumButtonWidth = int(70.0f * scale);
     // Position will be set after contentBounds is calculated
 
     auto contentBounds = bounds.reduced(margin, margin / 2);
+    presetBrowser.setBounds(contentBounds);
     int sectionWidth = (contentBounds.getWidth() - sectionGap * 2) / 3;
     int topRowHeight = int(130.0f * scale);
     int midRowHeight = int(130.0f * scale);
@@ -703,25 +1045,40 @@ void DX10AudioProcessorEditor::resized()
     octaveKnob.setBounds(knobArea.getX() + knobSpacing/2 - knobSize/2, knobArea.getY(), knobSize, knobArea.getHeight());
     fineTuneKnob.setBounds(knobArea.getX() + knobSpacing + knobSpacing/2 - knobSize/2, knobArea.getY(), knobSize, knobArea.getHeight());
 
-    // Row 2: Modulator Envelope (full width, 5 knobs)
-    auto modEnvBounds = juce::Rectangle<int>(contentBounds.getX(), contentBounds.getY() + topRowHeight + sectionGap, contentBounds.getWidth(), midRowHeight);
+    // Row 2: Modulator Envelope (5 knobs) and Stereo / Unison (4 knobs), as
+    // wide as their knob counts; the knobs shrink to fit
+    int modEnvWidth = (contentBounds.getWidth() - sectionGap) * 5 / 9;
+    auto modEnvBounds = juce::Rectangle<int>(contentBounds.getX(), contentBounds.getY() + topRowHeight + sectionGap, modEnvWidth, midRowHeight);
     knobArea = modEnvBounds.reduced(8, 0).withTrimmedTop(sectionPadding);
     knobSpacing = knobArea.getWidth() / 5;
+    int rowKnobSize = knobSize;
+    knobSize = juce::jmin(knobSize, knobSpacing);
     modInitKnob.setBounds(knobArea.getX() + knobSpacing/2 - knobSize/2, knobArea.getY(), knobSize, knobArea.getHeight());
     modDecKnob.setBounds(knobArea.getX() + knobSpacing + knobSpacing/2 - knobSize/2, knobArea.getY(), knobSize, knobArea.getHeight());
     modSusKnob.setBounds(knobArea.getX() + knobSpacing*2 + knobSpacing/2 - knobSize/2, knobArea.getY(), knobSize, knobArea.getHeight());
     modRelKnob.setBounds(knobArea.getX() + knobSpacing*3 + knobSpacing/2 - knobSize/2, knobArea.getY(), knobSize, knobArea.getHeight());
     modVelKnob.setBounds(knobArea.getX() + knobSpacing*4 + knobSpacing/2 - knobSize/2, knobArea.getY(), knobSize, knobArea.getHeight());
 
-    // Row 3: Output / LFO (full width, 7 knobs)
+    auto stereoBounds = juce::Rectangle<int>(modEnvBounds.getRight() + sectionGap, modEnvBounds.getY(), contentBounds.getRight() - modEnvBounds.getRight() - sectionGap, midRowHeight);
+    knobArea = stereoBounds.reduced(8, 0).withTrimmedTop(sectionPadding);
+    knobSpacing = knobArea.getWidth() / 4;
+    spreadKnob.setBounds(knobArea.getX() + knobSpacing/2 - knobSize/2, knobArea.getY(), knobSize, knobArea.getHeight());
+    panModeKnob.setBounds(knobArea.getX() + knobSpacing + knobSpacing/2 - knobSize/2, knobArea.getY(), knobSize, knobArea.getHeight());
+    unisonKnob.setBounds(knobArea.getX() + knobSpacing*2 + knobSpacing/2 - knobSize/2, knobArea.getY(), knobSize, knobArea.getHeight());
+    detuneKnob.setBounds(knobArea.getX() + knobSpacing*3 + knobSpacing/2 - knobSize/2, knobArea.getY(), knobSize, knobArea.getHeight());
+    knobSize = rowKnobSize;
+
+    // Row 3: Output / LFO (full width, 8 knobs)
     auto outputBounds = juce::Rectangle<int>(contentBounds.getX(), contentBounds.getY() + topRowHeight + midRowHeight + sectionGap * 2, contentBounds.getWidth(), bottomRowHeight);
     knobArea = outputBounds.reduced(8, 0).withTrimmedTop(sectionPadding);
-    knobSpacing = knobArea.getWidth() / 7;
+    knobSpacing = knobArea.getWidth() / 8;
+    knobSize = juce::jmin(knobSize, knobSpacing);
     vibratoKnob.setBounds(knobArea.getX() + knobSpacing/2 - knobSize/2, knobArea.getY(), knobSize, knobArea.getHeight());
     lfoRateKnob.setBounds(knobArea.getX() + knobSpacing + knobSpacing/2 - knobSize/2, knobArea.getY(), knobSize, knobArea.getHeight());
-    waveformKnob.setBounds(knobArea.getX() + knobSpacing*2 + knobSpacing/2 - knobSize/2, knobArea.getY(), knobSize, knobArea.getHeight());
-    modThruKnob.setBounds(knobArea.getX() + knobSpacing*3 + knobSpacing/2 - knobSize/2, knobArea.getY(), knobSize, knobArea.getHeight());
-    glideKnob.setBounds(knobArea.getX() + knobSpacing*4 + knobSpacing/2 - knobSize/2, knobArea.getY(), knobSize, knobArea.getHeight());
-    gainKnob.setBounds(knobArea.getX() + knobSpacing*5 + knobSpacing/2 - knobSize/2, knobArea.getY(), knobSize, knobArea.getHeight());
-    saturationKnob.setBounds(knobArea.getX() + knobSpacing*6 + knobSpacing/2 - knobSize/2, knobArea.getY(), knobSize, knobArea.getHeight());
+    lfoModeKnob.setBounds(knobArea.getX() + knobSpacing*2 + knobSpacing/2 - knobSize/2, knobArea.getY(), knobSize, knobArea.getHeight());
+    waveformKnob.setBounds(knobArea.getX() + knobSpacing*3 + knobSpacing/2 - knobSize/2, knobArea.getY(), knobSize, knobArea.getHeight());
+    modThruKnob.setBounds(knobArea.getX() + knobSpacing*4 + knobSpacing/2 - knobSize/2, knobArea.getY(), knobSize, knobArea.getHeight());
+    glideKnob.setBounds(knobArea.getX() + knobSpacing*5 + knobSpacing/2 - knobSize/2, knobArea.getY(), knobSize, knobArea.getHeight());
+    gainKnob.setBounds(knobArea.getX() + knobSpacing*6 + knobSpacing/2 - knobSize/2, knobArea.getY(), knobSize, knobArea.getHeight());
+    saturationKnob.setBounds(knobArea.getX() + knobSpacing*7 + knobSpacing/2 - knobSize/2, knobArea.getY(), knobSize, knobArea.getHeight());
 }
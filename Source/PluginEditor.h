@@ -6,11 +6,28 @@
 #include "RotaryKnobWithLabel.h"
 #include "SpectrumAnalyzer.h"
 #include "PresetManager.h"
+#include "PresetBrowser.h"
+#include "PerformanceMeter.h"
 #include <vector>
 #include <map>
 #include <algorithm>
 #include <functional>
 
+// The preset ComboBox, with a hook just before its menu opens, so the items
+// can be brought up to date then instead of on every change to the folder
+class PresetSelector : public juce::ComboBox
+{
+public:
+    std::function<void()> onPopup;
+
+    void showPopup() override
+    {
+        if (onPopup)
+            onPopup();
+        juce::ComboBox::showPopup();
+    }
+};
+
 class DX10AudioProcessorEditor : public juce::AudioProcessorEditor,
                                   private juce::AudioProcessorValueTreeState::Listener,
                                   public juce::FileDragAndDropTarget
@@ -21,6 +38,7 @@ public:
 
     void paint(juce::Graphics&) override;
     void resized() override;
+    bool keyPressed(const juce::KeyPress& key) override;
 
     // FileDragAndDropTarget
     bool isInterestedInFileDrag(const juce::StringArray& files) override;
@@ -32,17 +50,19 @@ private:
     void parameterChanged(const juce::String& parameterID, float newValue) override;
     
     DX10AudioProcessor& audioProcessor;
-    DX10LookAndFeel customLookAndFeel;
+    juce::SharedResourcePointer<DX10LookAndFeel> customLookAndFeel;  // one per process, shared by all editors
 
     // Preset management
     std::unique_ptr<PresetManager> presetManager;
-    juce::ComboBox presetSelector;
+    PresetSelector presetSelector;
     juce::TextButton savePresetButton { "Save" };
     juce::TextButton loadPresetButton { "Load" };
     juce::TextButton prevPresetButton { "<" };
     juce::TextButton nextPresetButton { ">" };
     juce::TextButton settingsButton { "..." };
+    juce::TextButton searchButton { "Find" };
     bool isUpdatingPresetSelector = false;
+    bool presetSelectorStale = true;  // the items lag the preset list until the menu opens
     bool isDragOver = false;
 
     // Undo/Redo buttons
@@ -52,22 +72,20 @@ private:
     // Spectrum Analyzer
     SpectrumAnalyzer spectrumAnalyzer;
 
+    // DSP load readout under the header buttons
+    PerformanceMeter performanceMeter;
+
     // Knobs
     RotaryKnobWithLabel attackKnob, decayKnob, releaseKnob;
     RotaryKnobWithLabel coarseKnob, fineKnob;
     RotaryKnobWithLabel modInitKnob, modDecKnob, modSusKnob, modRelKnob, modVelKnob;
     RotaryKnobWithLabel octaveKnob, fineTuneKnob;
-    RotaryKnobWithLabel vibratoKnob, waveformKnob, modThruKnob, lfoRateKnob;
+    RotaryKnobWithLabel vibratoKnob, waveformKnob, modThruKnob, lfoRateKnob, lfoModeKnob;
     RotaryKnobWithLabel gainKnob, saturationKnob, glideKnob;
+    RotaryKnobWithLabel spreadKnob, panModeKnob, unisonKnob, detuneKnob;
 
-    // Attachments
-    using SliderAttachment = juce::AudioProcessorValueTreeState::SliderAttachment;
-    std::unique_ptr<SliderAttachment> attackAttachment, decayAttachment, releaseAttachment;
-    std::unique_ptr<SliderAttachment> coarseAttachment, fineAttachment;
-    std::unique_ptr<SliderAttachment> modInitAttachment, modDecAttachment, modSusAttachment, modRelAttachment, modVelAttachment;
-    std::unique_ptr<SliderAttachment> octaveAttachment, fineTuneAttachment;
-    std::unique_ptr<SliderAttachment> vibratoAttachment, waveformAttachment, modThruAttachment, lfoRateAttachment;
-    std::unique_ptr<SliderAttachment> gainAttachment, saturationAttachment, glideAttachment;
+    // One attachment per knob, in snapshot parameter order
+    std::vector<std::unique_ptr<juce::SliderParameterAttachment>> attachments;
 
     void setupKnob(RotaryKnobWithLabel& knob, const juce::String& labelText);
     void drawSection(juce::Graphics& g, juce::Rectangle<int> bounds, const juce::String& title);
@@ -76,10 +94,25 @@ private:
     void loadPresetFromFile();
     void goToPreviousPreset();
     void goToNextPreset();
+    void stepPreset(int delta);
+    void prefetchAround(int presetId);
     void rebuildPresetList();
+    void updatePresetList();
+    void populatePresetSelector();
+    void selectPreset(int presetId, juce::NotificationType notification = juce::sendNotificationAsync);
+    void handlePresetChanges(const std::vector<PresetChange>& changes);
+    void indexPresetFile(const juce::File& file);
+    int getPresetIdForFile(const juce::File& file);  // indexes the file; 0 if it has no ID
+    void rebuildSearchIndex();
+    void showPresetBrowser(bool shouldShow);
     void showSettingsMenu();
     void selectPresetFolder();
-    int generatePresetIdFromFile(const juce::File& file);
+    void exportPresetBank();
+    void importPresetBank();
+    void loadTuning();
+    void exportPerformanceLog();
+    void toggleTraceRecording();
+    int generatePresetId(const juce::String& presetKey);
 
     juce::ComponentBoundsConstrainer constrainer;
 
@@ -87,14 +120,28 @@ private:
     int numFactoryPresets = 0;
     std::vector<FlatPresetItem> userPresets;
     
-    // Map combo box IDs to preset files (ID -> File)
-    std::map<int, juce::File> presetIdToFile;
+    // Map combo box IDs to preset entries (ID -> file or bank entry)
+    std::map<int, FlatPresetItem> presetIdToItem;
+    
+    // Map preset keys to preset IDs (Path or Path#BankIndex -> ID) for reverse lookup
+    std::map<juce::String, int> presetKeyToId;
     
-    // Map file paths to preset IDs (Path -> ID) for reverse lookup
-    std::map<juce::String, int> fileToPresetId;
+    // Preset IDs in list order, and the position of each ID in that order, so
+    // stepping through presets needs no sorting or searching
+    std::vector<int> navigationOrder;
+    std::map<int, int> navigationPosition;
     
     // Track the last loaded user preset for undo/display purposes
     juce::File lastLoadedUserPreset;
+    
+    // Search over the whole preset list; the index is rebuilt in the
+    // background whenever the list changes
+    PresetBrowser presetBrowser;
+    PresetSearchIndexer searchIndexer;
+    
+    // Feeds add / remove / rename deltas from the preset folder into the list.
+    // Declared last so it stops before the members its callback touches go away.
+    PresetDirectoryWatcher presetWatcher;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DX10AudioProcessorEditor);
 };
@@ -15,21 +15,43 @@ DX10Program::DX10Program(const char *name,
     param[12] = p12; param[13] = p13; param[14] = p14; param[15] = p15;
 }
 
+const char* const DX10AudioProcessor::parameterIDs[NSNAPSHOTPARAMS] = {
+    "Attack", "Decay", "Release", "Coarse", "Fine", "Mod Init", "Mod Dec", "Mod Sus",
+    "Mod Rel", "Mod Vel", "Vibrato", "Octave", "FineTune", "Waveform", "Mod Thru", "LFO Rate",
+    "Gain", "Saturation", "Glide", "Spread", "Pan Mode", "Unison", "Detune", "LFO Mode"
+};
+
+int DX10AudioProcessor::getSnapshotIndex(const juce::String& parameterID)
+{
+    for (int i = 0; i < NSNAPSHOTPARAMS; ++i)
+        if (parameterID == parameterIDs[i])
+            return i;
+    return -1;
+}
+
 DX10AudioProcessor::DX10AudioProcessor()
     : AudioProcessor(BusesProperties().withOutput("Output", juce::AudioChannelSet::stereo(), true))
 {
     _sampleRate = 44100.0f;
-    _inverseSampleRate = 1.0f / _sampleRate;
-    createPrograms();
-    _currentProgram = 15;  // Log Drum preset
-    _currentPresetName = _programs[15].name;  // Set initial preset name
-    
-    // Initialize parameters to Log Drum preset values
-    const char *paramNames[] = {"Attack","Decay","Release","Coarse","Fine","Mod Init","Mod Dec","Mod Sus","Mod Rel","Mod Vel","Vibrato","Octave","FineTune","Waveform","Mod Thru","LFO Rate"};
-    for (int i = 0; i < NPARAMS; ++i) {
-        if (auto* param = apvts.getParameter(paramNames[i]))
-            param->setValueNotifyingHost(_programs[15].param[i]);
+    for (auto& program : _channelPrograms)
+        program = -1;
+    
+    for (int i = 0; i < NSNAPSHOTPARAMS; ++i) {
+        _parameters[i] = apvts.getParameter(parameterIDs[i]);
+        _rawParameters[i] = apvts.getRawParameterValue(parameterIDs[i]);
+    }
+    
+    for (auto* parameter : getParameters()) {
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter)) {
+            jassert(std::find(_stateHashes.begin(), _stateHashes.end(), hashParameterID(ranged->paramID)) == _stateHashes.end());
+            _stateParameters.push_back(ranged);
+            _stateHashes.push_back(hashParameterID(ranged->paramID));
+        }
     }
+    
+    // The parameters already start out at the Log Drum preset (see createParameterLayout)
+    _currentProgram = initialProgram;
+    _currentPresetName = _programs[initialProgram].name;
 }
 
 DX10AudioProcessor::~DX10AudioProcessor() {}
@@ -39,6 +61,10 @@ int DX10AudioProcessor::getNumPrograms() { return int(_programs.size()); }
 
 int DX10AudioProcessor::getCurrentProgram()
 {
+    // A program change that hasn't reached the parameters yet
+    if (auto* snapshot = _publishedSnapshot.load(); snapshot != nullptr && snapshot->program >= 0)
+        return _currentProgram;
+    
     if (auto* param = apvts.getRawParameterValue("PresetIndex"))
         return static_cast<int>(param->load() * (NPRESETS - 1) + 0.5f);
     return _currentProgram;
@@ -51,24 +77,116 @@ void DX10AudioProcessor::setCurrentProgram(int index)
     
     if (index < 0 || index >= static_cast<int>(_programs.size())) return;
     
-    // Begin undo transaction for preset change
-    undoManager.beginNewTransaction("Load Preset: " + juce::String(_programs[index].name));
-    
+    // May be called on the audio thread (MIDI program change), so only swap in
+    // the prebuilt snapshot here; handleAsyncUpdate() does the rest
     _currentProgram = index;
-    _currentPresetName = _programs[index].name;  // Set the preset name
+    publishSnapshot(&_factorySnapshots[static_cast<size_t>(index)]);
+}
+
+void DX10AudioProcessor::applyPresetSnapshot(const ParameterSnapshot& snapshot, const juce::String& presetName, int presetId)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
     
-    // Update PresetIndex parameter
-    if (auto* param = apvts.getParameter("PresetIndex"))
-        param->setValueNotifyingHost(static_cast<float>(index) / static_cast<float>(NPRESETS - 1));
+    // Use a slot the audio thread cannot be reading
+    const auto* published = _publishedSnapshot.load();
+    const auto* inUse = _snapshotInUse.load();
+    ParameterSnapshot* slot = nullptr;
+    for (auto& candidate : _snapshotSlots) {
+        if (&candidate != published && &candidate != inUse) { slot = &candidate; break; }
+    }
+    jassert(slot != nullptr);
     
-    // Update SelectedPresetId parameter (index + 1 because factory presets are 1-based)
-    if (auto* param = apvts.getParameter("SelectedPresetId"))
-        param->setValueNotifyingHost(param->convertTo0to1(static_cast<float>(index + 1)));
+    *slot = snapshot;
+    slot->program = -1;
+    slot->presetId = presetId;
+    _pendingPresetName = presetName;
+    _currentPresetName = presetName;
+    publishSnapshot(slot);
+}
 
-    // Only set the 16 original FM synth parameters, preserve Gain and Saturation
-    const char *paramNames[] = {"Attack","Decay","Release","Coarse","Fine","Mod Init","Mod Dec","Mod Sus","Mod Rel","Mod Vel","Vibrato","Octave","FineTune","Waveform","Mod Thru","LFO Rate"};
-    for (int i = 0; i < NPARAMS; ++i)
-        apvts.getParameter(paramNames[i])->setValueNotifyingHost(_programs[index].param[i]);
+class DX10AudioProcessor::PresetChangeAction : public juce::UndoableAction
+{
+public:
+    PresetChangeAction(DX10AudioProcessor& p, std::vector<ParameterChange> c)
+        : processor(p), changes(std::move(c)) {}
+    
+    bool perform() override
+    {
+        for (const auto& change : changes)
+            processor.setParameterTreeValue(*change.parameter, change.after);
+        return true;
+    }
+    
+    bool undo() override
+    {
+        for (const auto& change : changes)
+            processor.setParameterTreeValue(*change.parameter, change.before);
+        return true;
+    }
+    
+    int getSizeInUnits() override
+    {
+        return static_cast<int>(sizeof(*this) + changes.size() * sizeof(ParameterChange));
+    }
+    
+private:
+    DX10AudioProcessor& processor;
+    const std::vector<ParameterChange> changes;
+};
+
+void DX10AudioProcessor::publishSnapshot(const ParameterSnapshot* snapshot)
+{
+    _publishedSnapshot.store(snapshot);
+    triggerAsyncUpdate();
+}
+
+void DX10AudioProcessor::handleAsyncUpdate()
+{
+    const auto* snapshot = _publishedSnapshot.load();
+    if (snapshot == nullptr) return;
+    
+    // Several presets published in quick succession end up here only once,
+    // with the latest one
+    const bool isFactory = snapshot->program >= 0;
+    const auto name = isFactory ? juce::String(_programs[static_cast<size_t>(snapshot->program)].name) : _pendingPresetName;
+    
+    std::vector<ParameterChange> changes;
+    auto addChange = [&changes](juce::RangedAudioParameter* param, float normalised) {
+        if (param != nullptr && param->getValue() != normalised)
+            changes.push_back({ param, param->convertFrom0to1(param->getValue()), param->convertFrom0to1(normalised) });
+    };
+    
+    if (isFactory) {
+        _currentPresetName = name;
+        
+        // Update PresetIndex parameter
+        addChange(apvts.getParameter("PresetIndex"), static_cast<float>(snapshot->program) / static_cast<float>(NPRESETS - 1));
+    }
+    
+    // The selector's preset is part of the same undo step as the sound, so
+    // one Undo brings both back
+    if (snapshot->presetId > 0) {
+        if (auto* param = apvts.getParameter("SelectedPresetId"))
+            addChange(param, param->convertTo0to1(static_cast<float>(snapshot->presetId)));
+    }
+    
+    // Only parameters that actually change reach the host and the undo history
+    for (int i = 0; i < NSNAPSHOTPARAMS; ++i) {
+        if (snapshot->has(i))
+            addChange(_parameters[i], snapshot->values[i]);
+    }
+    
+    // The whole load is one compact undo action rather than one per parameter
+    if (!changes.empty()) {
+        undoManager.beginNewTransaction("Load Preset: " + name);
+        undoManager.perform(new PresetChangeAction(*this, std::move(changes)));
+        undoManager.beginNewTransaction();
+    }
+    
+    // The parameters now hold the preset, so the audio thread can read them again
+    // (unless a newer snapshot was published meanwhile)
+    auto expected = snapshot;
+    _publishedSnapshot.compare_exchange_strong(expected, nullptr);
     
     // Notify host of program change
     updateHostDisplay(ChangeDetails().withProgramChanged(true));
@@ -92,384 +210,578 @@ juce::String DX10AudioProcessor::getPresetName(int index) const
 }
 
 void DX10AudioProcessor::changeProgramName(int, const juce::String&) {}
-void DX10AudioProcessor::prepareToPlay(double sampleRate, int) { _sampleRate = sampleRate; _inverseSampleRate = 1.0f / _sampleRate; resetState(); }
+void DX10AudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
+{
+    _sampleRate = float(sampleRate);
+    _maxBlockSize = juce::jmax(samplesPerBlock, 1);
+    prepareRendering();
+}
+
+void DX10AudioProcessor::prepareRendering()
+{
+    // At an internal rate the engine renders at it and the resampler converts
+    // to the host's. Ratios the resampler can't do exactly stay at the host rate.
+    const int hostRate = juce::roundToInt(_sampleRate);
+    const int internalRate = _internalRate;
+    _resampling = internalRate > 0 && internalRate != hostRate
+        && _resampler.prepare(internalRate, hostRate, _maxBlockSize)
+        && _resamplerDouble.prepare(internalRate, hostRate, _maxBlockSize);
+    setLatencySamples(_resampling ? _resampler.getLatency() : 0);
+    _blockRenderer.setResampling(_resampling);
+    _blockRendererDouble.setResampling(_resampling);
+    _blockRenderer.setMidiTuning(&_midiTuning);
+    _blockRendererDouble.setMidiTuning(&_midiTuning);
+    
+    // Cache memory goes to the engine for the host's precision. The engines
+    // let go of their caches first, as a new budget drops every note.
+    const auto cacheBytes = static_cast<size_t>(_noteCacheSize.load()) << 20;
+    const bool doublePrecision = isUsingDoublePrecision();
+    _engine.setNoteCache(nullptr);
+    _engineDouble.setNoteCache(nullptr);
+    if (_noteCache.getBudget() != (doublePrecision ? 0 : cacheBytes))
+        _noteCache.setBudget(doublePrecision ? 0 : cacheBytes);
+    if (_noteCacheDouble.getBudget() != (doublePrecision ? cacheBytes : 0))
+        _noteCacheDouble.setBudget(doublePrecision ? cacheBytes : 0);
+    
+    // The host may have switched precision, so bring that engine's tuning
+    // and channel programs up to date too
+    withEngine([&](auto& engine) {
+        engine.prepare(_resampling ? double(internalRate) : double(_sampleRate));
+        engine.setTuning(_midiTuning);
+    });
+    _channelProgramsChanged = true;
+    
+    if (cacheBytes > 0) {
+        if (doublePrecision)
+            _engineDouble.setNoteCache(&_noteCacheDouble);
+        else
+            _engine.setNoteCache(&_noteCache);
+    }
+}
+
+void DX10AudioProcessor::setInternalRate(int rate)
+{
+    if (_internalRate.exchange(rate) == rate)
+        return;
+    
+    // The resampler's tables are rebuilt while the audio thread is held off
+    if (_maxBlockSize > 0) {
+        suspendProcessing(true);
+        prepareRendering();
+        suspendProcessing(false);
+    }
+}
+
+void DX10AudioProcessor::setNoteCacheSize(int megabytes)
+{
+    if (_noteCacheSize.exchange(megabytes) == megabytes)
+        return;
+    
+    if (_maxBlockSize > 0) {
+        suspendProcessing(true);
+        prepareRendering();
+        suspendProcessing(false);
+    }
+}
+
 void DX10AudioProcessor::releaseResources() {}
-void DX10AudioProcessor::reset() { resetState(); }
+
+void DX10AudioProcessor::reset()
+{
+    withEngine([](auto& engine) { engine.reset(); });
+    _resampler.reset();
+    _resamplerDouble.reset();
+    _blockRenderer.reset();
+    _blockRendererDouble.reset();
+}
+
 bool DX10AudioProcessor::isBusesLayoutSupported(const BusesLayout &layouts) const { return layouts.getMainOutputChannelSet() == juce::AudioChannelSet::stereo(); }
 
-void DX10AudioProcessor::createPrograms()
-{
-    _programs.emplace_back("Bright E.Piano", 0.000f, 0.650f, 0.441f, 0.842f, 0.329f, 0.230f, 0.800f, 0.050f, 0.800f, 0.900f, 0.000f, 0.500f, 0.500f, 0.447f, 0.000f, 0.414f);
-    _programs.emplace_back("Jazz E.Piano",   0.000f, 0.500f, 0.100f, 0.671f, 0.000f, 0.441f, 0.336f, 0.243f, 0.800f, 0.500f, 0.000f, 0.500f, 0.500f, 0.178f, 0.000f, 0.500f);
-    _programs.emplace_back("E.Piano Pad",    0.000f, 0.700f, 0.400f, 0.230f, 0.184f, 0.270f, 0.474f, 0.224f, 0.800f, 0.974f, 0.250f, 0.500f, 0.500f, 0.428f, 0.836f, 0.500f);
-    _programs.emplace_back("Fuzzy E.Piano",  0.000f, 0.700f, 0.400f, 0.320f, 0.217f, 0.599f, 0.670f, 0.309f, 0.800f, 0.500f, 0.263f, 0.507f, 0.500f, 0.276f, 0.638f, 0.526f);
-    _programs.emplace_back("Soft Chimes",    0.400f, 0.600f, 0.650f, 0.760f, 0.000f, 0.390f, 0.250f, 0.160f, 0.900f, 0.500f, 0.362f, 0.500f, 0.500f, 0.401f, 0.296f, 0.493f);
-    _programs.emplace_back("Harpsichord",    0.000f, 0.342f, 0.000f, 0.280f, 0.000f, 0.880f, 0.100f, 0.408f, 0.740f, 0.000f, 0.000f, 0.600f, 0.500f, 0.842f, 0.651f, 0.500f);
-    _programs.emplace_back("Funk Clav",      0.000f, 0.400f, 0.100f, 0.360f, 0.000f, 0.875f, 0.160f, 0.592f, 0.800f, 0.500f, 0.000f, 0.500f, 0.500f, 0.303f, 0.868f, 0.500f);
-    _programs.emplace_back("Sitar",          0.000f, 0.500f, 0.704f, 0.230f, 0.000f, 0.151f, 0.750f, 0.493f, 0.770f, 0.500f, 0.000f, 0.400f, 0.500f, 0.421f, 0.632f, 0.500f);
-    _programs.emplace_back("Chiff Organ",    0.600f, 0.990f, 0.400f, 0.320f, 0.283f, 0.570f, 0.300f, 0.050f, 0.240f, 0.500f, 0.138f, 0.500f, 0.500f, 0.283f, 0.822f, 0.500f);
-    _programs.emplace_back("Tinkle",         0.000f, 0.500f, 0.650f, 0.368f, 0.651f, 0.395f, 0.550f, 0.257f, 0.900f, 0.500f, 0.300f, 0.800f, 0.500f, 0.000f, 0.414f, 0.500f);
-    _programs.emplace_back("Space Pad",      0.000f, 0.700f, 0.520f, 0.230f, 0.197f, 0.520f, 0.720f, 0.280f, 0.730f, 0.500f, 0.250f, 0.500f, 0.500f, 0.336f, 0.428f, 0.500f);
-    _programs.emplace_back("Koto",           0.000f, 0.240f, 0.000f, 0.390f, 0.000f, 0.880f, 0.100f, 0.600f, 0.740f, 0.500f, 0.000f, 0.500f, 0.500f, 0.526f, 0.480f, 0.500f);
-    _programs.emplace_back("Harp",           0.000f, 0.500f, 0.700f, 0.160f, 0.000f, 0.158f, 0.349f, 0.000f, 0.280f, 0.900f, 0.000f, 0.618f, 0.500f, 0.401f, 0.000f, 0.500f);
-    _programs.emplace_back("Jazz Guitar",    0.000f, 0.500f, 0.100f, 0.390f, 0.000f, 0.490f, 0.250f, 0.250f, 0.800f, 0.500f, 0.000f, 0.500f, 0.500f, 0.263f, 0.145f, 0.500f);
-    _programs.emplace_back("Steel Drum",     0.000f, 0.300f, 0.507f, 0.480f, 0.730f, 0.000f, 0.100f, 0.303f, 0.730f, 1.000f, 0.000f, 0.600f, 0.500f, 0.579f, 0.000f, 0.500f);
-    _programs.emplace_back("Log Drum",       0.000f, 0.300f, 0.500f, 0.320f, 0.000f, 0.467f, 0.079f, 0.158f, 0.500f, 0.500f, 0.000f, 0.400f, 0.500f, 0.151f, 0.020f, 0.500f);
-    _programs.emplace_back("Trumpet",        0.000f, 0.990f, 0.100f, 0.230f, 0.000f, 0.000f, 0.200f, 0.450f, 0.800f, 0.000f, 0.112f, 0.600f, 0.500f, 0.711f, 0.000f, 0.401f);
-    _programs.emplace_back("Horn",           0.280f, 0.990f, 0.280f, 0.230f, 0.000f, 0.180f, 0.400f, 0.300f, 0.800f, 0.500f, 0.000f, 0.400f, 0.500f, 0.217f, 0.480f, 0.500f);
-    _programs.emplace_back("Reed 1",         0.220f, 0.990f, 0.250f, 0.170f, 0.000f, 0.240f, 0.310f, 0.257f, 0.900f, 0.757f, 0.000f, 0.500f, 0.500f, 0.697f, 0.803f, 0.500f);
-    _programs.emplace_back("Reed 2",         0.220f, 0.990f, 0.250f, 0.450f, 0.070f, 0.240f, 0.310f, 0.360f, 0.900f, 0.500f, 0.211f, 0.500f, 0.500f, 0.184f, 0.000f, 0.414f);
-    _programs.emplace_back("Violin",         0.697f, 0.990f, 0.421f, 0.230f, 0.138f, 0.750f, 0.390f, 0.513f, 0.800f, 0.316f, 0.467f, 0.678f, 0.500f, 0.743f, 0.757f, 0.487f);
-    _programs.emplace_back("Chunky Bass",    0.000f, 0.400f, 0.000f, 0.280f, 0.125f, 0.474f, 0.250f, 0.100f, 0.500f, 0.500f, 0.000f, 0.400f, 0.500f, 0.579f, 0.592f, 0.500f);
-    _programs.emplace_back("E.Bass",         0.230f, 0.500f, 0.100f, 0.395f, 0.000f, 0.388f, 0.092f, 0.250f, 0.150f, 0.500f, 0.200f, 0.200f, 0.500f, 0.178f, 0.822f, 0.500f);
-    _programs.emplace_back("Clunk Bass",     0.000f, 0.600f, 0.400f, 0.230f, 0.000f, 0.450f, 0.320f, 0.050f, 0.900f, 0.500f, 0.000f, 0.200f, 0.500f, 0.520f, 0.105f, 0.500f);
-    _programs.emplace_back("Thick Bass",     0.000f, 0.600f, 0.400f, 0.170f, 0.145f, 0.290f, 0.350f, 0.100f, 0.900f, 0.500f, 0.000f, 0.400f, 0.500f, 0.441f, 0.309f, 0.500f);
-    _programs.emplace_back("Sine Bass",      0.000f, 0.600f, 0.490f, 0.170f, 0.151f, 0.099f, 0.400f, 0.000f, 0.900f, 0.500f, 0.000f, 0.400f, 0.500f, 0.118f, 0.013f, 0.500f);
-    _programs.emplace_back("Square Bass",    0.000f, 0.600f, 0.100f, 0.320f, 0.000f, 0.350f, 0.670f, 0.100f, 0.150f, 0.500f, 0.000f, 0.200f, 0.500f, 0.303f, 0.730f, 0.500f);
-    _programs.emplace_back("Upright Bass 1", 0.300f, 0.500f, 0.400f, 0.280f, 0.000f, 0.180f, 0.540f, 0.000f, 0.700f, 0.500f, 0.000f, 0.400f, 0.500f, 0.296f, 0.033f, 0.500f);
-    _programs.emplace_back("Upright Bass 2", 0.300f, 0.500f, 0.400f, 0.360f, 0.000f, 0.461f, 0.070f, 0.070f, 0.700f, 0.500f, 0.000f, 0.400f, 0.500f, 0.546f, 0.467f, 0.500f);
-    _programs.emplace_back("Harmonics",      0.000f, 0.500f, 0.500f, 0.280f, 0.000f, 0.330f, 0.200f, 0.000f, 0.700f, 0.500f, 0.000f, 0.500f, 0.500f, 0.151f, 0.079f, 0.500f);
-    _programs.emplace_back("Scratch",        0.000f, 0.500f, 0.000f, 0.000f, 0.240f, 0.580f, 0.630f, 0.000f, 0.000f, 0.500f, 0.000f, 0.600f, 0.500f, 0.816f, 0.243f, 0.500f);
-    _programs.emplace_back("Syn Tom",        0.000f, 0.355f, 0.350f, 0.000f, 0.105f, 0.000f, 0.000f, 0.200f, 0.500f, 0.500f, 0.000f, 0.645f, 0.500f, 1.000f, 0.296f, 0.500f);
-}
-
-void DX10AudioProcessor::resetState()
-{
-    for (int v = 0; v < NVOICES; ++v) { 
-        _voices[v].env = 0.0f; 
-        _voices[v].car = 0.0f; 
-        _voices[v].dcar = 0.0f; 
-        _voices[v].dcarTarget = 0.0f;
-        _voices[v].dcarGlide = 1.0f;
-        _voices[v].mod0 = 0.0f; 
-        _voices[v].mod1 = 0.0f; 
-        _voices[v].dmod = 0.0f; 
-        _voices[v].cdec = 0.99f; 
+DX10SharedData::DX10SharedData()
+{
+    programs.reserve(NPRESETS);
+    programs.emplace_back("Bright E.Piano", 0.000f, 0.650f, 0.441f, 0.842f, 0.329f, 0.230f, 0.800f, 0.050f, 0.800f, 0.900f, 0.000f, 0.500f, 0.500f, 0.447f, 0.000f, 0.414f);
+    programs.emplace_back("Jazz E.Piano",   0.000f, 0.500f, 0.100f, 0.671f, 0.000f, 0.441f, 0.336f, 0.243f, 0.800f, 0.500f, 0.000f, 0.500f, 0.500f, 0.178f, 0.000f, 0.500f);
+    programs.emplace_back("E.Piano Pad",    0.000f, 0.700f, 0.400f, 0.230f, 0.184f, 0.270f, 0.474f, 0.224f, 0.800f, 0.974f, 0.250f, 0.500f, 0.500f, 0.428f, 0.836f, 0.500f);
+    programs.emplace_back("Fuzzy E.Piano",  0.000f, 0.700f, 0.400f, 0.320f, 0.217f, 0.599f, 0.670f, 0.309f, 0.800f, 0.500f, 0.263f, 0.507f, 0.500f, 0.276f, 0.638f, 0.526f);
+    programs.emplace_back("Soft Chimes",    0.400f, 0.600f, 0.650f, 0.760f, 0.000f, 0.390f, 0.250f, 0.160f, 0.900f, 0.500f, 0.362f, 0.500f, 0.500f, 0.401f, 0.296f, 0.493f);
+    programs.emplace_back("Harpsichord",    0.000f, 0.342f, 0.000f, 0.280f, 0.000f, 0.880f, 0.100f, 0.408f, 0.740f, 0.000f, 0.000f, 0.600f, 0.500f, 0.842f, 0.651f, 0.500f);
+    programs.emplace_back("Funk Clav",      0.000f, 0.400f, 0.100f, 0.360f, 0.000f, 0.875f, 0.160f, 0.592f, 0.800f, 0.500f, 0.000f, 0.500f, 0.500f, 0.303f, 0.868f, 0.500f);
+    programs.emplace_back("Sitar",          0.000f, 0.500f, 0.704f, 0.230f, 0.000f, 0.151f, 0.750f, 0.493f, 0.770f, 0.500f, 0.000f, 0.400f, 0.500f, 0.421f, 0.632f, 0.500f);
+    programs.emplace_back("Chiff Organ",    0.600f, 0.990f, 0.400f, 0.320f, 0.283f, 0.570f, 0.300f, 0.050f, 0.240f, 0.500f, 0.138f, 0.500f, 0.500f, 0.283f, 0.822f, 0.500f);
+    programs.emplace_back("Tinkle",         0.000f, 0.500f, 0.650f, 0.368f, 0.651f, 0.395f, 0.550f, 0.257f, 0.900f, 0.500f, 0.300f, 0.800f, 0.500f, 0.000f, 0.414f, 0.500f);
+    programs.emplace_back("Space Pad",      0.000f, 0.700f, 0.520f, 0.230f, 0.197f, 0.520f, 0.720f, 0.280f, 0.730f, 0.500f, 0.250f, 0.500f, 0.500f, 0.336f, 0.428f, 0.500f);
+    programs.emplace_back("Koto",           0.000f, 0.240f, 0.000f, 0.390f, 0.000f, 0.880f, 0.100f, 0.600f, 0.740f, 0.500f, 0.000f, 0.500f, 0.500f, 0.526f, 0.480f, 0.500f);
+    programs.emplace_back("Harp",           0.000f, 0.500f, 0.700f, 0.160f, 0.000f, 0.158f, 0.349f, 0.000f, 0.280f, 0.900f, 0.000f, 0.618f, 0.500f, 0.401f, 0.000f, 0.500f);
+    programs.emplace_back("Jazz Guitar",    0.000f, 0.500f, 0.100f, 0.390f, 0.000f, 0.490f, 0.250f, 0.250f, 0.800f, 0.500f, 0.000f, 0.500f, 0.500f, 0.263f, 0.145f, 0.500f);
+    programs.emplace_back("Steel Drum",     0.000f, 0.300f, 0.507f, 0.480f, 0.730f, 0.000f, 0.100f, 0.303f, 0.730f, 1.000f, 0.000f, 0.600f, 0.500f, 0.579f, 0.000f, 0.500f);
+    programs.emplace_back("Log Drum",       0.000f, 0.300f, 0.500f, 0.320f, 0.000f, 0.467f, 0.079f, 0.158f, 0.500f, 0.500f, 0.000f, 0.400f, 0.500f, 0.151f, 0.020f, 0.500f);
+    programs.emplace_back("Trumpet",        0.000f, 0.990f, 0.100f, 0.230f, 0.000f, 0.000f, 0.200f, 0.450f, 0.800f, 0.000f, 0.112f, 0.600f, 0.500f, 0.711f, 0.000f, 0.401f);
+    programs.emplace_back("Horn",           0.280f, 0.990f, 0.280f, 0.230f, 0.000f, 0.180f, 0.400f, 0.300f, 0.800f, 0.500f, 0.000f, 0.400f, 0.500f, 0.217f, 0.480f, 0.500f);
+    programs.emplace_back("Reed 1",         0.220f, 0.990f, 0.250f, 0.170f, 0.000f, 0.240f, 0.310f, 0.257f, 0.900f, 0.757f, 0.000f, 0.500f, 0.500f, 0.697f, 0.803f, 0.500f);
+    programs.emplace_back("Reed 2",         0.220f, 0.990f, 0.250f, 0.450f, 0.070f, 0.240f, 0.310f, 0.360f, 0.900f, 0.500f, 0.211f, 0.500f, 0.500f, 0.184f, 0.000f, 0.414f);
+    programs.emplace_back("Violin",         0.697f, 0.990f, 0.421f, 0.230f, 0.138f, 0.750f, 0.390f, 0.513f, 0.800f, 0.316f, 0.467f, 0.678f, 0.500f, 0.743f, 0.757f, 0.487f);
+    programs.emplace_back("Chunky Bass",    0.000f, 0.400f, 0.000f, 0.280f, 0.125f, 0.474f, 0.250f, 0.100f, 0.500f, 0.500f, 0.000f, 0.400f, 0.500f, 0.579f, 0.592f, 0.500f);
+    programs.emplace_back("E.Bass",         0.230f, 0.500f, 0.100f, 0.395f, 0.000f, 0.388f, 0.092f, 0.250f, 0.150f, 0.500f, 0.200f, 0.200f, 0.500f, 0.178f, 0.822f, 0.500f);
+    programs.emplace_back("Clunk Bass",     0.000f, 0.600f, 0.400f, 0.230f, 0.000f, 0.450f, 0.320f, 0.050f, 0.900f, 0.500f, 0.000f, 0.200f, 0.500f, 0.520f, 0.105f, 0.500f);
+    programs.emplace_back("Thick Bass",     0.000f, 0.600f, 0.400f, 0.170f, 0.145f, 0.290f, 0.350f, 0.100f, 0.900f, 0.500f, 0.000f, 0.400f, 0.500f, 0.441f, 0.309f, 0.500f);
+    programs.emplace_back("Sine Bass",      0.000f, 0.600f, 0.490f, 0.170f, 0.151f, 0.099f, 0.400f, 0.000f, 0.900f, 0.500f, 0.000f, 0.400f, 0.500f, 0.118f, 0.013f, 0.500f);
+    programs.emplace_back("Square Bass",    0.000f, 0.600f, 0.100f, 0.320f, 0.000f, 0.350f, 0.670f, 0.100f, 0.150f, 0.500f, 0.000f, 0.200f, 0.500f, 0.303f, 0.730f, 0.500f);
+    programs.emplace_back("Upright Bass 1", 0.300f, 0.500f, 0.400f, 0.280f, 0.000f, 0.180f, 0.540f, 0.000f, 0.700f, 0.500f, 0.000f, 0.400f, 0.500f, 0.296f, 0.033f, 0.500f);
+    programs.emplace_back("Upright Bass 2", 0.300f, 0.500f, 0.400f, 0.360f, 0.000f, 0.461f, 0.070f, 0.070f, 0.700f, 0.500f, 0.000f, 0.400f, 0.500f, 0.546f, 0.467f, 0.500f);
+    programs.emplace_back("Harmonics",      0.000f, 0.500f, 0.500f, 0.280f, 0.000f, 0.330f, 0.200f, 0.000f, 0.700f, 0.500f, 0.000f, 0.500f, 0.500f, 0.151f, 0.079f, 0.500f);
+    programs.emplace_back("Scratch",        0.000f, 0.500f, 0.000f, 0.000f, 0.240f, 0.580f, 0.630f, 0.000f, 0.000f, 0.500f, 0.000f, 0.600f, 0.500f, 0.816f, 0.243f, 0.500f);
+    programs.emplace_back("Syn Tom",        0.000f, 0.355f, 0.350f, 0.000f, 0.105f, 0.000f, 0.000f, 0.200f, 0.500f, 0.500f, 0.000f, 0.645f, 0.500f, 1.000f, 0.296f, 0.500f);
+    
+    // Factory presets only set the 16 FM parameters, preserving the output and stereo settings
+    factorySnapshots.resize(programs.size());
+    for (size_t p = 0; p < programs.size(); ++p) {
+        factorySnapshots[p].program = static_cast<int>(p);
+        factorySnapshots[p].presetId = static_cast<int>(p) + 1;  // factory preset IDs are 1-based
+        for (int i = 0; i < NPARAMS; ++i)
+            factorySnapshots[p].set(i, programs[p].param[i]);
     }
-    _numActiveVoices = 0; 
-    _notes[0] = EVENTS_DONE; 
-    _modWheel = 0.0f; 
-    _pitchBend = 1.0f; 
-    _volume = 0.0035f; 
-    _sustain = 0; 
-    _lfoStep = 0; 
-    _lfo0 = 0.0f; 
-    _lfo1 = 1.0f; 
-    _modulationAmount = 0.0f;
-    _lastNote = -1;
-    _glideTime = 0.0f;
-    _portamentoTimeCC = -1.0f;
-    _portamentoOnCC = false;
-    _portamentoRate = 1.0f;
+}
+
+void DX10AudioProcessor::readParameterValues(float* values)
+{
+    // Announce which snapshot we're reading before using it, and re-check that
+    // it is still the published one, so the message thread never reuses it
+    // underneath us
+    const ParameterSnapshot* snapshot = nullptr;
+    do {
+        snapshot = _publishedSnapshot.load();
+        _snapshotInUse.store(snapshot);
+    } while (snapshot != _publishedSnapshot.load());
+    
+    for (int i = 0; i < NSNAPSHOTPARAMS; ++i)
+        values[i] = (snapshot != nullptr && snapshot->has(i)) ? snapshot->values[i] : _rawParameters[i]->load();
+    
+    _snapshotInUse.store(nullptr);
 }
 
 void DX10AudioProcessor::update()
 {
-    float param11 = apvts.getRawParameterValue("Octave")->load();
-    _tune = 8.175798915644f * _inverseSampleRate * std::pow(2.0f, std::floor(param11 * 6.9f) - 2.0f);
-    float param12 = apvts.getRawParameterValue("FineTune")->load();
-    _fineTune = param12 + param12 - 1.0f;
-    float coarse = apvts.getRawParameterValue("Coarse")->load();
-    coarse = std::floor(40.1f * coarse * coarse);
-    float fine = apvts.getRawParameterValue("Fine")->load();
-    if (fine < 0.5f) { fine = 0.2f * fine * fine; }
-    else { switch (int(8.9f * fine)) { case 4: fine = 0.25f; break; case 5: fine = 0.33333333f; break; case 6: fine = 0.50f; break; case 7: fine = 0.66666667f; break; default: fine = 0.75f; } }
-    _ratio = 1.570796326795f * (coarse + fine);
-    _velocitySensitivity = apvts.getRawParameterValue("Mod Vel")->load();
-    float param10 = apvts.getRawParameterValue("Vibrato")->load();
-    _vibrato = 0.001f * param10 * param10;
-    float param0 = apvts.getRawParameterValue("Attack")->load();
-    _attack = 1.0f - std::exp(-_inverseSampleRate * std::exp(8.0f - 8.0f * param0));
-    float param1 = apvts.getRawParameterValue("Decay")->load();
-    if (param1 > 0.98f) { _decay = 1.0f; } else { _decay = std::exp(-_inverseSampleRate * std::exp(5.0f - 8.0f * param1)); }
-    float param2 = apvts.getRawParameterValue("Release")->load();
-    _release = std::exp(-_inverseSampleRate * std::exp(5.0f - 5.0f * param2));
-    float param5 = apvts.getRawParameterValue("Mod Init")->load();
-    _modInitialLevel = 0.0002f * param5 * param5;
-    float param6 = apvts.getRawParameterValue("Mod Dec")->load();
-    _modDecay = 1.0f - std::exp(-_inverseSampleRate * std::exp(6.0f - 7.0f * param6));
-    float param7 = apvts.getRawParameterValue("Mod Sus")->load();
-    _modSustain = 0.0002f * param7 * param7;
-    float param8 = apvts.getRawParameterValue("Mod Rel")->load();
-    _modRelease = 1.0f - std::exp(-_inverseSampleRate * std::exp(5.0f - 8.0f * param8));
-    float param13 = apvts.getRawParameterValue("Waveform")->load();
-    _richness = 0.50f - 3.0f * param13 * param13;
-    float param14 = apvts.getRawParameterValue("Mod Thru")->load();
-    _modMix = 0.25f * param14 * param14;
-    float param15 = apvts.getRawParameterValue("LFO Rate")->load();
-    _lfoInc = 628.3f * _inverseSampleRate * 25.0f * param15 * param15;
-    
-    // Output section
-    float gainParam = apvts.getRawParameterValue("Gain")->load();
-    _outputGain = std::pow(10.0f, (gainParam * 24.0f - 12.0f) / 20.0f);  // -12dB to +12dB
-    _saturation = apvts.getRawParameterValue("Saturation")->load();
-    
-    // Glide/Portamento - use CC override if set, otherwise use UI knob
-    float glideParam = (_portamentoTimeCC >= 0.0f) ? _portamentoTimeCC : apvts.getRawParameterValue("Glide")->load();
-    _glideTime = glideParam;
-    if (glideParam < 0.01f) {
-        _portamentoRate = 1.0f;  // Instant (no glide)
-    } else {
-        // Calculate glide rate: how much to move toward target per sample
-        // glideParam 0-1 maps to approximately 5ms to 2000ms glide time
-        float glideSeconds = 0.005f + glideParam * glideParam * 2.0f;
-        // Rate is fraction of distance to cover per sample
-        // After N samples, we want to be ~95% there, so rate = 1 - e^(-3/N)
-        float samplesForGlide = glideSeconds * _sampleRate;
-        _portamentoRate = 1.0f - std::exp(-3.0f / samplesForGlide);
-    }
+    DX10_TRACE_SCOPE("update");
+    DX10EngineParameters params;
+    readParameterValues(params.values);
+    withEngine([&](auto& engine) { engine.setParams(params); });
 }
 
-void DX10AudioProcessor::processEvents(juce::MidiBuffer &midiMessages)
+juce::String DX10AudioProcessor::setTuning(const juce::String& scale, const juce::String& mapping)
 {
-    int npos = 0;
-    for (const auto metadata : midiMessages) {
-        if (metadata.numBytes != 3) continue;
-        const auto data0 = metadata.data[0]; const auto data1 = metadata.data[1]; const auto data2 = metadata.data[2];
-        const int deltaFrames = metadata.samplePosition;
-        const int status = data0 & 0xF0;
+    DX10Tuning tuning;
+    if (scale.isNotEmpty() || mapping.isNotEmpty()) {
+        // A mapping on its own maps the standard 12-note scale
+        juce::String scaleText = scale;
+        if (scaleText.isEmpty()) {
+            scaleText = "12-TET\n12\n";
+            for (int degree = 1; degree <= 12; ++degree)
+                scaleText << degree * 100 << ".0\n";
+        }
         
-        switch (status) {
-            case 0x80: // Note Off
-                _notes[npos++] = deltaFrames; 
-                _notes[npos++] = data1 & 0x7F; 
-                _notes[npos++] = 0; 
-                break;
-                
-            case 0x90: // Note On
-                _notes[npos++] = deltaFrames; 
-                _notes[npos++] = data1 & 0x7F; 
-                _notes[npos++] = data2 & 0x7F;
-                break;
-                
-            case 0xB0: // Control Change
-                switch (data1) {
-                    case 0x01: _modWheel = 0.00000005f * float(data2 * data2); break;
-                    case 0x05: // CC #5 - Portamento Time (overrides knob if received)
-                        _portamentoTimeCC = float(data2) / 127.0f;
-                        break;
-                    case 0x07: _volume = 0.00000035f * float(data2 * data2); break;
-                    case 0x40: _sustain = data2 & 0x40; 
-                        if (_sustain == 0) { 
-                            _notes[npos++] = deltaFrames; 
-                            _notes[npos++] = SUSTAIN; 
-                            _notes[npos++] = 0; 
-                        } 
-                        break;
-                    case 0x41: // CC #65 - Portamento On/Off (overrides knob if received)
-                        _portamentoOnCC = (data2 >= 64);
-                        break;
-                    default: 
-                        if (data1 > 0x7A) { 
-                            for (int v = 0; v < NVOICES; ++v) _voices[v].cdec = 0.99f; 
-                            _sustain = 0; 
-                        } 
-                        break;
-                }
-                break;
-                
-            case 0xC0: // Program Change
-                if (data1 < _programs.size()) setCurrentProgram(data1); 
-                break;
-                
-            case 0xE0: // Pitch Bend
-                _pitchBend = float(data1 + 128 * data2 - 8192); 
-                _pitchBend = (_pitchBend > 0.0f) ? 1.0f + 0.000014951f * _pitchBend : 1.0f + 0.000013318f * _pitchBend; 
-                break;
-                
-            default: break;
+        std::string error;
+        if (!tuning.loadScala(scaleText.toStdString(), mapping.toStdString(), error))
+            return error;
+    }
+    
+    // Use a slot the audio thread cannot be reading
+    const auto* published = _publishedTuning.load();
+    const auto* inUse = _tuningInUse.load();
+    for (auto& candidate : _tuningSlots) {
+        if (&candidate != published && &candidate != inUse) {
+            candidate = tuning;
+            _publishedTuning.store(&candidate);
+            break;
         }
-        if (npos > EVENTBUFFER) npos -= 3;
     }
-    _notes[npos] = EVENTS_DONE;
-    midiMessages.clear();
+    _tuningScale = scale;
+    _tuningMapping = mapping;
+    return {};
+}
+
+void DX10AudioProcessor::updateTuning()
+{
+    // Same handshake as readParameterValues(): announce the table before
+    // copying it, and only take it while it is still the published one
+    const DX10Tuning* tuning = nullptr;
+    do {
+        tuning = _publishedTuning.load();
+        _tuningInUse.store(tuning);
+    } while (tuning != _publishedTuning.load());
+    
+    if (tuning != nullptr) {
+        _midiTuning = *tuning;
+        withEngine([&](auto& engine) { engine.setTuning(_midiTuning); });
+        _publishedTuning.compare_exchange_strong(tuning, nullptr);
+    }
+    _tuningInUse.store(nullptr);
+}
+
+void DX10AudioProcessor::applyChannelProgram(int channel)
+{
+    // The channel gets the factory preset's FM parameters on top of the
+    // current output and stereo settings, like a preset load
+    const int program = _channelPrograms[channel];
+    if (program < 0 || program >= static_cast<int>(_programs.size())) {
+        withEngine([&](auto& engine) { engine.clearChannelParams(channel); });
+        return;
+    }
+    
+    DX10EngineParameters params;
+    readParameterValues(params.values);
+    for (int i = 0; i < NPARAMS; ++i)
+        params[i] = _programs[static_cast<size_t>(program)].param[i];
+    withEngine([&](auto& engine) { engine.setChannelParams(channel, params); });
 }
 
 void DX10AudioProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages)
+{
+    renderBlock(buffer, midiMessages, _blockRenderer);
+}
+
+void DX10AudioProcessor::processBlock(juce::AudioBuffer<double> &buffer, juce::MidiBuffer &midiMessages)
+{
+    renderBlock(buffer, midiMessages, _blockRendererDouble);
+}
+
+template <typename Sample>
+void DX10AudioProcessor::renderBlock(juce::AudioBuffer<Sample>& buffer, juce::MidiBuffer& midiMessages,
+                                     DX10BlockRenderer<Sample>& renderer)
 {
     juce::ScopedNoDenormals noDenormals;
+    DX10_TRACE_SCOPE("processBlock");
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    const int numSamples = buffer.getNumSamples();
+    const int numEvents = midiMessages.getNumEvents();
+    auto& engine = renderer.getEngine();
+    
+    // Idle: nothing sounds and nothing arrives, so the block is silence and
+    // only the engine's clock moves on. Parameter, tuning and mode changes
+    // wait for the next block with MIDI in it, which applies them before
+    // its first note.
+    if (renderer.isIdle() && numEvents == 0) {
+        buffer.clear();
+        renderer.skip(numSamples);
+        if (spectrumAnalyzer != nullptr)
+            spectrumAnalyzer->pushBuffer(buffer);
+        recordBlockStats(startTicks, numSamples, 0, 0);
+        return;
+    }
+    
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i) buffer.clear(i, 0, buffer.getNumSamples());
 
+    // Mode switches and restored channel programs reach the engine here, so
+    // only the audio thread ever touches it
+    const auto channelMode = getChannelMode();
+    if (channelMode != engine.getChannelMode()) {
+        engine.setChannelMode(channelMode);
+        _channelProgramsChanged = true;
+    }
+    
+    updateTuning();
     update();
-    processEvents(midiMessages);
-
-    int sampleFrames = buffer.getNumSamples();
-    float *out1 = buffer.getWritePointer(0);
-    float *out2 = buffer.getWritePointer(1);
-    int event = 0, frame = 0;
-
-    if (_numActiveVoices > 0 || _notes[event] < sampleFrames) {
-        while (frame < sampleFrames) {
-            int frames = _notes[event++];
-            if (frames > sampleFrames) frames = sampleFrames;
-            frames -= frame;
-            frame += frames;
-
-            while (--frames >= 0) {
-                Voice *V = _voices;
-                float o = 0.0f;
-                if (--_lfoStep < 0) { _lfo0 += _lfoInc * _lfo1; _lfo1 -= _lfoInc * _lfo0; _modulationAmount = _lfo1 * (_modWheel + _vibrato); _lfoStep = 100; }
-                for (int v = 0; v < NVOICES; ++v) {
-                    float e = V->env;
-                    if (e > SILENCE) {
-                        // Apply pitch glide/portamento
-                        if (V->dcarGlide < 1.0f && std::abs(V->dcar - V->dcarTarget) > 0.00001f) {
-                            V->dcar += V->dcarGlide * (V->dcarTarget - V->dcar);
-                        } else {
-                            V->dcar = V->dcarTarget;
-                        }
-                        
-                        // Calculate current pitch with pitch bend applied
-                        float currentPitch = V->dcar * _pitchBend;
-                        
-                        V->env = e * V->cdec;
-                        V->cenv += V->catt * (e - V->cenv);
-                        
-                        // Update modulator with current pitch (including pitch bend)
-                        float modPitch = _ratio * currentPitch;
-                        V->dmod = 2.0f * std::cos(modPitch);
-                        float y = V->dmod * V->mod0 - V->mod1; V->mod1 = V->mod0; V->mod0 = y;
-                        
-                        V->menv += V->mdec * (V->mlev - V->menv);
-                        float x = V->car + currentPitch + y * V->menv + _modulationAmount;
-                        while (x > 1.0f) x -= 2.0f; while (x < -1.0f) x += 2.0f;
-                        V->car = x;
-                        float s = x + x * x * x * (_richness * x * x - 1.0f - _richness);
-                        o += V->cenv * (_modMix * V->mod1 + s);
-                    }
-                    V++;
-                }
-                
-                // Apply saturation (soft clipping)
-                if (_saturation > 0.0f) {
-                    float satAmount = _saturation * 4.0f;
-                    o = std::tanh(o * (1.0f + satAmount)) / (1.0f + satAmount * 0.5f);
-                }
-                
-                // Apply output gain
-                o *= _outputGain;
-                
-                *out1++ = o; *out2++ = o;
+    
+    if (_channelProgramsChanged.exchange(false)) {
+        for (int channel = 1; channel < NCHANNELS; ++channel)
+            applyChannelProgram(channel);
+    }
+
+    // Program changes are the plugin's business; the renderer feeds the
+    // engine the rest
+    Sample* outputs[2] = { buffer.getWritePointer(0), buffer.getWritePointer(1) };
+    renderer.render(outputs, numSamples, midiMessages, [&](int channel, int program) {
+        if (channelMode == ChannelMode::multiTimbral && channel > 0) {
+            if (static_cast<size_t>(program) < _programs.size()) {
+                _channelPrograms[channel] = program;
+                applyChannelProgram(channel);
             }
-            if (frame < sampleFrames) { int note = _notes[event++]; int vel = _notes[event++]; noteOn(note, vel); }
-        }
-        _numActiveVoices = NVOICES;
-        for (int v = 0; v < NVOICES; ++v) {
-            if (_voices[v].env < SILENCE) { _voices[v].env = 0.0f; _voices[v].cenv = 0.0f; _numActiveVoices--; }
-            if (_voices[v].menv < SILENCE) { _voices[v].menv = 0.0f; _voices[v].mlev = 0.0f; }
+        } else {
+            setCurrentProgram(program);
         }
-    } else {
-        while (--sampleFrames >= 0) { *out1++ = 0.0f; *out2++ = 0.0f; }
-    }
-    _notes[0] = EVENTS_DONE;
+    });
+    jassert(renderer.getNumDropped() == 0);
+    midiMessages.clear();
 
     // Push audio to spectrum analyzer
     if (spectrumAnalyzer != nullptr)
         spectrumAnalyzer->pushBuffer(buffer);
+    
+    recordBlockStats(startTicks, numSamples, numEvents, engine.getNumActiveVoices());
 }
 
-void DX10AudioProcessor::noteOn(int note, int velocity)
+void DX10AudioProcessor::recordBlockStats(juce::int64 startTicks, int numSamples, int numEvents, int activeVoices)
 {
-    if (velocity > 0) {
-        float l = 1.0f; int vl = 0;
-        for (int v = 0; v < NVOICES; v++) { if (_voices[v].env < l) { l = _voices[v].env; vl = v; } }
-        
-        // Calculate base pitch (without pitch bend - bend is applied in processBlock)
-        float p = std::exp(0.05776226505f * (float(note) + _fineTune));
-        float targetDcar = _tune * p;
-        
-        _voices[vl].note = note;
-        
-        // Check if glide should be applied (either via knob or CC)
-        bool useGlide = (_glideTime > 0.01f) || _portamentoOnCC;
-        if (useGlide && _lastNote >= 0 && _lastNote != note) {
-            // Start from last note pitch, glide to new pitch
-            float lastP = std::exp(0.05776226505f * (float(_lastNote) + _fineTune));
-            _voices[vl].dcar = _tune * lastP;
-            _voices[vl].dcarTarget = targetDcar;
-            _voices[vl].dcarGlide = _portamentoRate;
-            // Don't reset carrier phase for smooth glide
-        } else {
-            // No glide - instant pitch
-            _voices[vl].dcar = targetDcar;
-            _voices[vl].dcarTarget = targetDcar;
-            _voices[vl].dcarGlide = 1.0f;
-            _voices[vl].car = 0.0f;  // Reset phase only for non-glide notes
-        }
-        
-        _lastNote = note;  // Remember this note for next glide
-        
-        if (p > 50.0f) p = 50.0f;
-        p *= (64.0f + _velocitySensitivity * (velocity - 64));
-        _voices[vl].menv = _modInitialLevel * p;
-        _voices[vl].mlev = _modSustain * p;
-        _voices[vl].mdec = _modDecay;
-        _voices[vl].dmod = _ratio * _voices[vl].dcar;
-        _voices[vl].mod0 = 0.0f;
-        _voices[vl].mod1 = std::sin(_voices[vl].dmod);
-        _voices[vl].dmod = 2.0f * std::cos(_voices[vl].dmod);
-        float param13 = apvts.getRawParameterValue("Waveform")->load();
-        _voices[vl].env = (1.5f - param13) * _volume * (velocity + 10);
-        _voices[vl].cdec = _decay;
-        _voices[vl].catt = _attack;
-        _voices[vl].cenv = 0.0f;
-    } else {
-        for (int v = 0; v < NVOICES; v++) {
-            if (_voices[v].note == note) {
-                if (_sustain == 0) { _voices[v].cdec = _release; _voices[v].env = _voices[v].cenv; _voices[v].catt = 1.0f; _voices[v].mlev = 0.0f; _voices[v].mdec = _modRelease; }
-                else { _voices[v].note = SUSTAIN; }
+    BlockStats stats;
+    stats.startTicks = startTicks;
+    stats.durationMs = static_cast<float>(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0);
+    stats.load = numSamples > 0 ? stats.durationMs * 0.001f * _sampleRate / static_cast<float>(numSamples) : 0.0f;
+    stats.numSamples = numSamples;
+    stats.activeVoices = activeVoices;
+    stats.events = numEvents;
+    _telemetry.record(stats);
+}
+
+double DX10AudioProcessor::getTailLengthSeconds() const
+{
+    // Released notes ring for as long as the carrier release lets them. The
+    // modulator and its Mod Rel only shape the sound under that envelope, so
+    // they never make a note last longer.
+    DX10EngineParameters params;
+    params[DX10EngineParameters::release] = _rawParameters[DX10EngineParameters::release]->load();
+    double seconds = DX10Engine::getReleaseSeconds(params);
+    
+    // In multi-timbral mode the channel programs' releases count as well
+    if (getChannelMode() == ChannelMode::multiTimbral) {
+        for (int channel = 1; channel < NCHANNELS; ++channel) {
+            const int program = _channelPrograms[channel];
+            if (program >= 0 && program < static_cast<int>(_programs.size())) {
+                params[DX10EngineParameters::release] = _programs[static_cast<size_t>(program)].param[DX10EngineParameters::release];
+                seconds = juce::jmax(seconds, DX10Engine::getReleaseSeconds(params));
             }
         }
     }
+    return seconds;
 }
 
 juce::AudioProcessorEditor *DX10AudioProcessor::createEditor() { return new DX10AudioProcessorEditor(*this); }
 
-void DX10AudioProcessor::getStateInformation(juce::MemoryBlock &destData) { copyXmlToBinary(*apvts.copyState().createXml(), destData); }
+void DX10AudioProcessor::getStateInformation(juce::MemoryBlock &destData)
+{
+    // Make sure a preset that is still being applied ends up in the saved state
+    if (juce::MessageManager::existsAndIsCurrentThread())
+        handleUpdateNowIfNeeded();
+    
+    juce::MemoryOutputStream out(destData, false);
+    out.writeInt(static_cast<int>(stateMagic));
+    out.writeInt(static_cast<int>(stateVersion));
+    out.writeInt(static_cast<int>(_stateParameters.size()));
+    for (size_t i = 0; i < _stateParameters.size(); ++i) {
+        out.writeInt(static_cast<int>(_stateHashes[i]));
+        out.writeFloat(_stateParameters[i]->convertFrom0to1(_stateParameters[i]->getValue()));
+    }
+    
+    out.writeInt(_channelMode);
+    for (const auto& program : _channelPrograms)
+        out.writeInt(program);
+    
+    out.writeString(_tuningScale);
+    out.writeString(_tuningMapping);
+    
+    out.writeInt(_internalRate);
+    out.writeInt(_noteCacheSize);
+}
 
 void DX10AudioProcessor::setStateInformation(const void *data, int sizeInBytes)
+{
+    // Sessions saved before the binary format hold the APVTS tree as XML
+    std::vector<std::pair<int, float>> values;
+    if (readBinaryState(data, sizeInBytes, values) || readXmlState(data, sizeInBytes, values))
+        restoreParameterValues(values);
+    readChannelState(data, sizeInBytes);
+    readTuningState(data, sizeInBytes);
+    readRenderState(data, sizeInBytes);
+}
+
+void DX10AudioProcessor::readChannelState(const void* data, int sizeInBytes)
+{
+    // Older states have no channel section: single-timbral, channels unassigned
+    int channelMode = static_cast<int>(ChannelMode::single);
+    int programs[NCHANNELS];
+    std::fill(std::begin(programs), std::end(programs), -1);
+    
+    const auto* bytes = static_cast<const char*>(data);
+    if (sizeInBytes >= 12 && juce::ByteOrder::littleEndianInt(bytes) == stateMagic
+        && juce::ByteOrder::littleEndianInt(bytes + 4) >= 2) {
+        const auto offset = 12 + static_cast<size_t>(juce::ByteOrder::littleEndianInt(bytes + 8)) * 8;
+        if (offset + 4 * (1 + NCHANNELS) <= static_cast<size_t>(sizeInBytes)) {
+            channelMode = juce::jlimit(static_cast<int>(ChannelMode::single), static_cast<int>(ChannelMode::mpe),
+                                       static_cast<int>(juce::ByteOrder::littleEndianInt(bytes + offset)));
+            for (int channel = 0; channel < NCHANNELS; ++channel)
+                programs[channel] = static_cast<int>(juce::ByteOrder::littleEndianInt(bytes + offset + 4 * static_cast<size_t>(1 + channel)));
+        }
+    }
+    
+    for (int channel = 0; channel < NCHANNELS; ++channel)
+        _channelPrograms[channel] = programs[channel];
+    _channelMode = channelMode;
+    _channelProgramsChanged = true;
+}
+
+void DX10AudioProcessor::readTuningState(const void* data, int sizeInBytes)
+{
+    // Older states are in standard tuning
+    juce::String scale, mapping;
+    
+    const auto* bytes = static_cast<const char*>(data);
+    if (sizeInBytes >= 12 && juce::ByteOrder::littleEndianInt(bytes) == stateMagic
+        && juce::ByteOrder::littleEndianInt(bytes + 4) >= 3) {
+        const auto offset = 12 + static_cast<size_t>(juce::ByteOrder::littleEndianInt(bytes + 8)) * 8 + 4 * (1 + NCHANNELS);
+        if (offset < static_cast<size_t>(sizeInBytes)) {
+            juce::MemoryInputStream in(bytes + offset, static_cast<size_t>(sizeInBytes) - offset, false);
+            scale = in.readString();
+            mapping = in.readString();
+        }
+    }
+    
+    // A tuning that no longer parses falls back to standard tuning
+    if (setTuning(scale, mapping).isNotEmpty())
+        setTuning({}, {});
+}
+
+void DX10AudioProcessor::readRenderState(const void* data, int sizeInBytes)
+{
+    // Older states render at the host rate, without a note cache
+    int internalRate = 0, noteCacheSize = 0;
+    
+    // The internal rate and the note cache size follow the tuning texts
+    const auto* bytes = static_cast<const char*>(data);
+    if (sizeInBytes >= 12 && juce::ByteOrder::littleEndianInt(bytes) == stateMagic
+        && juce::ByteOrder::littleEndianInt(bytes + 4) >= 4) {
+        const auto offset = 12 + static_cast<size_t>(juce::ByteOrder::littleEndianInt(bytes + 8)) * 8 + 4 * (1 + NCHANNELS);
+        if (offset < static_cast<size_t>(sizeInBytes)) {
+            juce::MemoryInputStream in(bytes + offset, static_cast<size_t>(sizeInBytes) - offset, false);
+            in.readString();
+            in.readString();
+            if (in.getNumBytesRemaining() >= 4)
+                internalRate = juce::jlimit(0, 384000, in.readInt());
+            if (juce::ByteOrder::littleEndianInt(bytes + 4) >= 5 && in.getNumBytesRemaining() >= 4)
+                noteCacheSize = juce::jlimit(0, 1024, in.readInt());
+        }
+    }
+    
+    setInternalRate(internalRate);
+    setNoteCacheSize(noteCacheSize);
+}
+
+juce::uint32 DX10AudioProcessor::hashParameterID(const juce::String& parameterID)
+{
+    // FNV-1a over the UTF-8 bytes
+    juce::uint32 hash = 2166136261u;
+    for (auto* p = parameterID.toRawUTF8(); *p != 0; ++p)
+        hash = (hash ^ static_cast<juce::uint8>(*p)) * 16777619u;
+    return hash;
+}
+
+bool DX10AudioProcessor::readBinaryState(const void* data, int sizeInBytes, std::vector<std::pair<int, float>>& values) const
+{
+    const auto* bytes = static_cast<const char*>(data);
+    if (sizeInBytes < 12 || juce::ByteOrder::littleEndianInt(bytes) != stateMagic)
+        return false;
+    
+    const auto version = juce::ByteOrder::littleEndianInt(bytes + 4);
+    const auto count = static_cast<size_t>(juce::ByteOrder::littleEndianInt(bytes + 8));
+    if (version < 1 || version > stateVersion || 12 + count * 8 > static_cast<size_t>(sizeInBytes))
+        return false;
+    
+    // Entries for parameters this build doesn't know are skipped
+    for (size_t entry = 0; entry < count; ++entry) {
+        const auto* p = bytes + 12 + entry * 8;
+        auto it = std::find(_stateHashes.begin(), _stateHashes.end(), juce::ByteOrder::littleEndianInt(p));
+        if (it == _stateHashes.end())
+            continue;
+        
+        auto bits = juce::ByteOrder::littleEndianInt(p + 4);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        values.emplace_back(static_cast<int>(it - _stateHashes.begin()), value);
+    }
+    return true;
+}
+
+bool DX10AudioProcessor::readXmlState(const void* data, int sizeInBytes, std::vector<std::pair<int, float>>& values) const
 {
     std::unique_ptr<juce::XmlElement> xml(getXmlFromBinary(data, sizeInBytes));
-    if (xml.get() != nullptr && xml->hasTagName(apvts.state.getType())) {
-        _isRestoringState = true;
-        apvts.replaceState(juce::ValueTree::fromXml(*xml));
-        if (auto* param = apvts.getRawParameterValue("PresetIndex"))
-            _currentProgram = static_cast<int>(param->load() * (NPRESETS - 1) + 0.5f);
-        _isRestoringState = false;
+    if (xml.get() == nullptr || !xml->hasTagName(apvts.state.getType()))
+        return false;
+    
+    for (auto* child : xml->getChildWithTagNameIterator("PARAM")) {
+        auto id = child->getStringAttribute("id");
+        for (size_t i = 0; i < _stateParameters.size(); ++i) {
+            if (_stateParameters[i]->paramID == id) {
+                values.emplace_back(static_cast<int>(i), static_cast<float>(child->getDoubleAttribute("value")));
+                break;
+            }
+        }
     }
+    return true;
+}
+
+void DX10AudioProcessor::restoreParameterValues(const std::vector<std::pair<int, float>>& values)
+{
+    _isRestoringState = true;
+    _publishedSnapshot.store(nullptr);
+    cancelPendingUpdate();
+    
+    // Write straight into the existing parameter trees in one pass instead of
+    // replacing the whole state: unchanged parameters stay quiet, and nothing
+    // is recorded for undo
+    for (const auto& entry : values)
+        setParameterTreeValue(*_stateParameters[static_cast<size_t>(entry.first)], entry.second);
+    undoManager.clearUndoHistory();
+    
+    if (auto* param = apvts.getRawParameterValue("PresetIndex"))
+        _currentProgram = static_cast<int>(param->load() * (NPRESETS - 1) + 0.5f);
+    _isRestoringState = false;
+}
+
+void DX10AudioProcessor::setSelectedPresetId(int presetId)
+{
+    if (auto* param = apvts.getParameter("SelectedPresetId"))
+        setParameterTreeValue(*param, static_cast<float>(presetId));
+}
+
+void DX10AudioProcessor::setParameterTreeValue(const juce::RangedAudioParameter& parameter, float value)
+{
+    // The APVTS pushes tree changes to the parameter and the host. Without an
+    // UndoManager nothing is recorded, and an unchanged value is ignored.
+    auto tree = apvts.state.getChildWithProperty("id", parameter.paramID);
+    if (tree.isValid())
+        tree.setProperty("value", value, nullptr);
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout DX10AudioProcessor::createParameterLayout()
 {
     juce::AudioProcessorValueTreeState::ParameterLayout layout;
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("PresetIndex", 1), "Preset", juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Attack", 1), "Attack", juce::NormalisableRange<float>(), 0.0f, juce::AudioParameterFloatAttributes().withLabel("%").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 100.0f)); })));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Decay", 1), "Decay", juce::NormalisableRange<float>(), 0.65f, juce::AudioParameterFloatAttributes().withLabel("%").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 100.0f)); })));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Release", 1), "Release", juce::NormalisableRange<float>(), 0.441f, juce::AudioParameterFloatAttributes().withLabel("%").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 100.0f)); })));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Coarse", 1), "Coarse", juce::NormalisableRange<float>(), 0.842f, juce::AudioParameterFloatAttributes().withLabel("ratio").withStringFromValueFunction([](float v, int) { return juce::String(int(std::floor(40.1f * v * v))); })));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Fine", 1), "Fine", juce::NormalisableRange<float>(), 0.329f, juce::AudioParameterFloatAttributes().withLabel("ratio").withStringFromValueFunction([](float v, int) { float f = 0.0f; if (v < 0.5f) { f = 0.2f * v * v; } else { switch (int(8.9f * v)) { case 4: f = 0.25f; break; case 5: f = 0.33333333f; break; case 6: f = 0.50f; break; case 7: f = 0.66666667f; break; default: f = 0.75f; } } return juce::String(f, 3); })));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Mod Init", 1), "Mod Init", juce::NormalisableRange<float>(), 0.23f, juce::AudioParameterFloatAttributes().withLabel("%").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 100.0f)); })));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Mod Dec", 1), "Mod Dec", juce::NormalisableRange<float>(), 0.8f, juce::AudioParameterFloatAttributes().withLabel("%").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 100.0f)); })));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Mod Sus", 1), "Mod Sus", juce::NormalisableRange<float>(), 0.05f, juce::AudioParameterFloatAttributes().withLabel("%").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 100.0f)); })));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Mod Rel", 1), "Mod Rel", juce::NormalisableRange<float>(), 0.8f, juce::AudioParameterFloatAttributes().withLabel("%").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 100.0f)); })));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Mod Vel", 1), "Mod Vel", juce::NormalisableRange<float>(), 0.9f, juce::AudioParameterFloatAttributes().withLabel("%").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 100.0f)); })));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Vibrato", 1), "Vibrato", juce::NormalisableRange<float>(), 0.0f, juce::AudioParameterFloatAttributes().withLabel("%").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 100.0f)); })));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Octave", 1), "Octave", juce::NormalisableRange<float>(), 0.5f, juce::AudioParameterFloatAttributes().withStringFromValueFunction([](float v, int) { return juce::String(int(v * 6.9f) - 3); })));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("FineTune", 1), "FineTune", juce::NormalisableRange<float>(), 0.5f, juce::AudioParameterFloatAttributes().withLabel("cents").withStringFromValueFunction([](float v, int) { return juce::String(int(200.0f * v - 100.0f)); })));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Waveform", 1), "Waveform", juce::NormalisableRange<float>(), 0.447f, juce::AudioParameterFloatAttributes().withLabel("%").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 100.0f)); })));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Mod Thru", 1), "Mod Thru", juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f, juce::AudioParameterFloatAttributes().withLabel("%").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 100.0f)); })));
-    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("LFO Rate", 1), "LFO Rate", juce::NormalisableRange<float>(0.0f, 1.0f), 0.414f, juce::AudioParameterFloatAttributes().withLabel("Hz").withStringFromValueFunction([](float v, int) { return juce::String(25.0f * v * v, 2); })));
+    
+    // Defaults are the initial preset, so a new instance needs no parameter changes
+    const float* initial = _shared->programs[initialProgram].param;
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("PresetIndex", 1), "Preset", juce::NormalisableRange<float>(0.0f, 1.0f), float(initialProgram) / float(NPRESETS - 1)));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Attack", 1), "Attack", juce::NormalisableRange<float>(), initial[0], juce::AudioParameterFloatAttributes().withLabel("%").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 100.0f)); })));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Decay", 1), "Decay", juce::NormalisableRange<float>(), initial[1], juce::AudioParameterFloatAttributes().withLabel("%").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 100.0f)); })));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Release", 1), "Release", juce::NormalisableRange<float>(), initial[2], juce::AudioParameterFloatAttributes().withLabel("%").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 100.0f)); })));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Coarse", 1), "Coarse", juce::NormalisableRange<float>(), initial[3], juce::AudioParameterFloatAttributes().withLabel("ratio").withStringFromValueFunction([](float v, int) { return juce::String(int(std::floor(40.1f * v * v))); })));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Fine", 1), "Fine", juce::NormalisableRange<float>(), initial[4], juce::AudioParameterFloatAttributes().withLabel("ratio").withStringFromValueFunction([](float v, int) { float f = 0.0f; if (v < 0.5f) { f = 0.2f * v * v; } else { switch (int(8.9f * v)) { case 4: f = 0.25f; break; case 5: f = 0.33333333f; break; case 6: f = 0.50f; break; case 7: f = 0.66666667f; break; default: f = 0.75f; } } return juce::String(f, 3); })));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Mod Init", 1), "Mod Init", juce::NormalisableRange<float>(), initial[5], juce::AudioParameterFloatAttributes().withLabel("%").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 100.0f)); })));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Mod Dec", 1), "Mod Dec", juce::NormalisableRange<float>(), initial[6], juce::AudioParameterFloatAttributes().withLabel("%").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 100.0f)); })));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Mod Sus", 1), "Mod Sus", juce::NormalisableRange<float>(), initial[7], juce::AudioParameterFloatAttributes().withLabel("%").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 100.0f)); })));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Mod Rel", 1), "Mod Rel", juce::NormalisableRange<float>(), initial[8], juce::AudioParameterFloatAttributes().withLabel("%").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 100.0f)); })));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Mod Vel", 1), "Mod Vel", juce::NormalisableRange<float>(), initial[9], juce::AudioParameterFloatAttributes().withLabel("%").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 100.0f)); })));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Vibrato", 1), "Vibrato", juce::NormalisableRange<float>(), initial[10], juce::AudioParameterFloatAttributes().withLabel("%").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 100.0f)); })));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Octave", 1), "Octave", juce::NormalisableRange<float>(), initial[11], juce::AudioParameterFloatAttributes().withStringFromValueFunction([](float v, int) { return juce::String(int(v * 6.9f) - 3); })));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("FineTune", 1), "FineTune", juce::NormalisableRange<float>(), initial[12], juce::AudioParameterFloatAttributes().withLabel("cents").withStringFromValueFunction([](float v, int) { return juce::String(int(200.0f * v - 100.0f)); })));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Waveform", 1), "Waveform", juce::NormalisableRange<float>(), initial[13], juce::AudioParameterFloatAttributes().withLabel("%").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 100.0f)); })));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Mod Thru", 1), "Mod Thru", juce::NormalisableRange<float>(0.0f, 1.0f), initial[14], juce::AudioParameterFloatAttributes().withLabel("%").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 100.0f)); })));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("LFO Rate", 1), "LFO Rate", juce::NormalisableRange<float>(0.0f, 1.0f), initial[15], juce::AudioParameterFloatAttributes().withLabel("Hz").withStringFromValueFunction([](float v, int) { return juce::String(25.0f * v * v, 2); })));
     layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Gain", 1), "Gain", juce::NormalisableRange<float>(0.0f, 1.0f), 0.5f, juce::AudioParameterFloatAttributes().withLabel("dB").withStringFromValueFunction([](float v, int) { return juce::String(v * 24.0f - 12.0f, 1); })));
     layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Saturation", 1), "Saturation", juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f, juce::AudioParameterFloatAttributes().withLabel("%").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 100.0f)); })));
     layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Glide", 1), "Glide", juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f, juce::AudioParameterFloatAttributes().withLabel("ms").withStringFromValueFunction([](float v, int) { 
         if (v < 0.01f) return juce::String("Off");
         return juce::String(int(v * v * 2000.0f));  // 0-2000ms range, exponential
     })));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Spread", 1), "Spread", juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f, juce::AudioParameterFloatAttributes().withLabel("%").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 100.0f)); })));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Pan Mode", 1), "Pan Mode", juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f, juce::AudioParameterFloatAttributes().withStringFromValueFunction([](float v, int) { return juce::String(v < 0.5f ? "Key" : "Random"); })));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Unison", 1), "Unison", juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f, juce::AudioParameterFloatAttributes().withLabel("voices").withStringFromValueFunction([](float v, int) { return juce::String(1 + int(v * (NUNISON - 0.01f))); })));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("Detune", 1), "Detune", juce::NormalisableRange<float>(0.0f, 1.0f), 0.3f, juce::AudioParameterFloatAttributes().withLabel("cents").withStringFromValueFunction([](float v, int) { return juce::String(int(v * 25.0f)); })));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID("LFO Mode", 1), "LFO Mode", juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f, juce::AudioParameterFloatAttributes().withStringFromValueFunction([](float v, int) {
+        static const char* const modes[] = { "Shared", "Free", "Key Sync" };
+        return juce::String(modes[int(v * 2.99f)]);
+    })));
     // Hidden parameter to track selected preset ID for undo (1-32 = factory, 1001+ = user)
-    // Default to 16 = Log Drum preset
-    layout.add(std::make_unique<juce::AudioParameterInt>(juce::ParameterID("SelectedPresetId", 1), "SelectedPresetId", 1, 999999, 16));
+    // Default to the initial (Log Drum) preset
+    layout.add(std::make_unique<juce::AudioParameterInt>(juce::ParameterID("SelectedPresetId", 1), "SelectedPresetId", 1, 999999, initialProgram + 1));
     return layout;
 }
 
@@ -1,13 +1,16 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "BoundedUndoManager.h"
+#include "BlockTelemetry.h"
+#include "TraceRecorder.h"
+#include "DX10BlockRenderer.h"
+#include "DX10Engine.h"
+#include "DX10Resampler.h"
+#include "DX10NoteCache.h"
 
-const int NPARAMS = 16;       // number of parameters
-const int NVOICES = 8;        // max polyphony
 const int NPRESETS = 32;      // number of factory presets
 
-const float SILENCE = 0.0003f;  // voice choking
-
 // Describes a factory preset.
 struct DX10Program
 {
@@ -20,42 +23,39 @@ struct DX10Program
     float param[NPARAMS];
 };
 
-// State for an active voice.
-struct Voice
+// An immutable set of parameter values that is handed to the audio thread in
+// one atomic pointer swap, so a block never renders a half-applied preset.
+// Indices follow DX10AudioProcessor::parameterIDs.
+struct ParameterSnapshot
+{
+    float values[NSNAPSHOTPARAMS] = {};
+    juce::uint32 mask = 0;  // bit i is set if values[i] belongs to the preset
+    int program = -1;       // factory program index, or -1 for a user preset
+    int presetId = 0;       // SelectedPresetId the load selects, or 0 to leave it
+
+    void set(int index, float value) { values[index] = value; mask |= (1u << index); }
+    bool has(int index) const { return (mask & (1u << index)) != 0; }
+};
+
+// Read-only data every instance needs: the factory bank and its prebuilt
+// snapshots. Built once per process and shared through
+// juce::SharedResourcePointer, so many instances hold one copy.
+struct DX10SharedData
 {
-    // What note triggered this voice, or SUSTAIN when the key is released
-    // but the sustain pedal is still held down. 0 if the voice is inactive.
-    int note;
-
-    // Carrier oscillator
-    float car;   // current phase value
-    float dcar;  // phase increment
-    
-    // Target phase increment for glide
-    float dcarTarget;  // target phase increment (for portamento/glide)
-    float dcarGlide;   // glide rate (0 = instant, closer to 1 = slower glide)
-
-    // Modulator sine oscillator
-    float dmod;  // phase increment
-    float mod0;
-    float mod1;
-
-    // Carrier envelope
-    float env;   // current envelope level
-    float cenv;  // smoothed envelope that includes the attack portion
-    float catt;  // smoothing coefficient for attack
-    float cdec;  // decay mutiplier
-
-    // Modulator envelope
-    float menv;  // current envelope level
-    float mlev;  // target level
-    float mdec;  // decay multiplier
+    DX10SharedData();
+
+    std::vector<DX10Program> programs;
+    
+    // Factory presets as snapshots, so a MIDI program change can switch
+    // presets on the audio thread without allocating.
+    std::vector<ParameterSnapshot> factorySnapshots;
 };
 
 // Forward declaration
 class SpectrumAnalyzer;
 
-class DX10AudioProcessor : public juce::AudioProcessor
+class DX10AudioProcessor : public juce::AudioProcessor,
+                           private juce::AsyncUpdater
 {
 public:
     DX10AudioProcessor();
@@ -68,6 +68,8 @@ public:
     bool isBusesLayoutSupported(const BusesLayout &layouts) const override;
 
     void processBlock(juce::AudioBuffer<float> &, juce::MidiBuffer &) override;
+    void processBlock(juce::AudioBuffer<double> &, juce::MidiBuffer &) override;
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     juce::AudioProcessorEditor *createEditor() override;
     bool hasEditor() const override { return true; }
@@ -77,7 +79,7 @@ public:
     bool acceptsMidi() const override { return true; }
     bool producesMidi() const override { return false; }
     bool isMidiEffect() const override { return false; }
-    double getTailLengthSeconds() const override { return 0.0; }
+    double getTailLengthSeconds() const override;
 
     int getNumPrograms() override;
     int getCurrentProgram() override;
@@ -88,8 +90,14 @@ public:
     void getStateInformation(juce::MemoryBlock &destData) override;
     void setStateInformation(const void *data, int sizeInBytes) override;
 
-    // UndoManager for undo/redo support
-    juce::UndoManager undoManager;
+private:
+    // Factory presets and tables shared with the other instances. Declared
+    // ahead of apvts, whose parameter defaults come from the factory bank.
+    juce::SharedResourcePointer<DX10SharedData> _shared;
+
+public:
+    // UndoManager for undo/redo support, with a bounded memory footprint
+    BoundedUndoManager undoManager;
     
     // APVTS with UndoManager
     juce::AudioProcessorValueTreeState apvts { *this, &undoManager, "Parameters", createParameterLayout() };
@@ -106,124 +114,198 @@ public:
     
     // Spectrum analyzer data access
     void setSpectrumAnalyzer(SpectrumAnalyzer* analyzer) { spectrumAnalyzer = analyzer; }
+    
+    // Timing, voice and event counts of every processed block
+    BlockTelemetry& getTelemetry() { return _telemetry; }
+    
+    // IDs of the parameters a snapshot can hold, in snapshot order.
+    static const char* const parameterIDs[NSNAPSHOTPARAMS];
+    static int getSnapshotIndex(const juce::String& parameterID);
+    juce::RangedAudioParameter* getSnapshotParameter(int index) const { return _parameters[index]; }
+    
+    // Apply a user preset. The audio thread switches to the whole snapshot at
+    // the next block; parameters, undo and the host are brought in line
+    // afterwards in one coalesced pass on the message thread.
+    void applyPresetSnapshot(const ParameterSnapshot& snapshot, const juce::String& presetName, int presetId = 0);
+    
+    // Points SelectedPresetId at a preset without loading it, as after a
+    // save. Not an undo step: the sound doesn't change.
+    void setSelectedPresetId(int presetId);
+    
+    // How MIDI channels are used (see DX10Engine::ChannelMode). In
+    // multi-timbral mode channel 1 follows the parameters; a program change on
+    // any other channel gives it that factory preset, otherwise it plays
+    // channel 1's. Takes effect at the next block and is saved with the state,
+    // as the enum's numeric value.
+    using ChannelMode = DX10Engine::ChannelMode;
+    void setChannelMode(ChannelMode mode) { _channelMode = static_cast<int>(mode); }
+    ChannelMode getChannelMode() const { return static_cast<ChannelMode>(_channelMode.load()); }
+    
+    // Microtuning from Scala scale and keyboard mapping texts, either empty
+    // for 12-TET and the default mapping. The table is built here; the audio
+    // thread picks it up at the next block, and notes started from then on
+    // use it. Saved with the state. Returns an error message, empty on success.
+    juce::String setTuning(const juce::String& scale, const juce::String& mapping);
+    const juce::String& getTuningScale() const { return _tuningScale; }
+    const juce::String& getTuningMapping() const { return _tuningMapping; }
+    
+    // Sample rate the voices render at, in Hz, or 0 for the host's. At any
+    // other rate the output is resampled to the host rate, adding under a
+    // millisecond of reported latency, and CPU use no longer grows with the
+    // session's sample rate. Changing it briefly suspends processing and
+    // silences the engine. Saved with the state.
+    void setInternalRate(int rate);
+    int getInternalRate() const { return _internalRate; }
+    
+    // Memory for the note cache in megabytes, 0 to render every note live
+    // (see DX10NoteCache). Changing it also suspends processing briefly.
+    // Saved with the state.
+    void setNoteCacheSize(int megabytes);
+    int getNoteCacheSize() const { return _noteCacheSize; }
 
 private:
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
+    template <typename Sample>
+    void renderBlock(juce::AudioBuffer<Sample>& buffer, juce::MidiBuffer& midiMessages,
+                     DX10BlockRenderer<Sample>& renderer);
+    void prepareRendering();
     void update();
-    void resetState();
-
-    void createPrograms();
-    void processEvents(juce::MidiBuffer &midiMessages);
-    void noteOn(int note, int velocity);
-
-    // The factory presets.
-    std::vector<DX10Program> _programs;
+    void applyChannelProgram(int channel);
+    void updateTuning();
+    void readParameterValues(float* values);
+    void recordBlockStats(juce::int64 startTicks, int numSamples, int numEvents, int activeVoices);
+    void publishSnapshot(const ParameterSnapshot* snapshot);
+    void handleAsyncUpdate() override;
+
+    // Compact plugin state: magic, version, parameter count, then one
+    // (parameter ID hash, value) pair per parameter, all little-endian.
+    static constexpr juce::uint32 stateMagic = 0x54535844;  // "DXST"
+    // Version 2 appends the channel mode and the channel programs, version 3
+    // the Scala tuning texts, version 4 the internal rate, version 5 the note
+    // cache size.
+    static constexpr juce::uint32 stateVersion = 5;
+    static juce::uint32 hashParameterID(const juce::String& parameterID);
+    bool readBinaryState(const void* data, int sizeInBytes, std::vector<std::pair<int, float>>& values) const;
+    bool readXmlState(const void* data, int sizeInBytes, std::vector<std::pair<int, float>>& values) const;
+    void readChannelState(const void* data, int sizeInBytes);
+    void readTuningState(const void* data, int sizeInBytes);
+    void readRenderState(const void* data, int sizeInBytes);
+    void restoreParameterValues(const std::vector<std::pair<int, float>>& values);
+    void setParameterTreeValue(const juce::RangedAudioParameter& parameter, float value);
+    
+    // Undo step for a preset load: only the parameters it changed, before and after.
+    struct ParameterChange
+    {
+        juce::RangedAudioParameter* parameter;
+        float before, after;  // denormalised, as stored in the state tree
+    };
+    class PresetChangeAction;
+
+    // Views into the shared factory bank.
+    const std::vector<DX10Program>& _programs = _shared->programs;
+    const std::vector<ParameterSnapshot>& _factorySnapshots = _shared->factorySnapshots;
+    
+    // Slots for user preset snapshots. Only the message thread writes them, and
+    // never the one that is published or being read by the audio thread.
+    ParameterSnapshot _snapshotSlots[3];
+    
+    // Snapshot the audio thread should render from, or nullptr once the
+    // parameters themselves hold the same values.
+    std::atomic<const ParameterSnapshot*> _publishedSnapshot { nullptr };
+    
+    // Snapshot the audio thread is reading right now (hazard pointer).
+    std::atomic<const ParameterSnapshot*> _snapshotInUse { nullptr };
+    
+    // Name of the last published user preset (message thread only).
+    juce::String _pendingPresetName;
+    
+    // Cached parameter objects and raw values, in snapshot order.
+    juce::RangedAudioParameter* _parameters[NSNAPSHOTPARAMS] = {};
+    std::atomic<float>* _rawParameters[NSNAPSHOTPARAMS] = {};
+    
+    // Every host parameter and the hash of its ID, in the order the state is written.
+    std::vector<juce::RangedAudioParameter*> _stateParameters;
+    std::vector<juce::uint32> _stateHashes;
 
+    // Factory preset a new instance starts with (Log Drum)
+    static constexpr int initialProgram = 15;
+    
     // Index of the active preset (kept in sync with PresetIndex parameter)
     int _currentProgram;
     
     // Current preset name (for display, especially for user presets)
     juce::String _currentPresetName;
 
-    // The current sample rate and 1 / sample rate.
-    float _sampleRate, _inverseSampleRate;
-
-    // MIDI note on / note off events for the current block. Each event is
-    // described by 3 values: delta time, note number, velocity.
-    static const int EVENTBUFFER = 120;
-    int _notes[EVENTBUFFER + 8];
-
-    // Special event code that marks the end of the MIDI events list.
-    const int EVENTS_DONE = 99999999;
-
-    // Special "note number" that says this voice is now kept alive by the
-    // sustain pedal being pressed down. As soon as the pedal is released,
-    // this voice will fade out.
-    const int SUSTAIN = 128;
-
-    // List of the active voices.
-    Voice _voices[NVOICES] = { 0 };
-
-    // How many voices are currently in use.
-    int _numActiveVoices;
-
-    // The LFO only updates every 100 samples. This counter keeps track of when
-    // the next update is.
-    int _lfoStep;
-
-    // Used by the LFO to approximate a sine wave.
-    float _lfo0, _lfo1;
-
-    // Current amount of mod wheel + vibrato modulation. Because the LFO is only
-    // updated every 100 samples, we need to keep track of this across calls to
-    // processBlock().
-    float _modulationAmount;
-
-    // === Parameter values ===
-
-    // Tuning: number of octaves up or down.
-    float _tune;
-
-    // Fine-tuning: between -1.0 and +1.0 semitones (or -100 to +100 cents).
-    float _fineTune;
-
-    // Modulator ratio as a multiple of the carrier frequency.
-    float _ratio;
-
-    // Carrier envelope settings.
-    float _attack, _decay, _release;
-
-    // Modulator envelope settings.
-    float _modInitialLevel, _modDecay, _modSustain, _modRelease;
-
-    // Velocity sensitivity for the modulator envelope (for brightness).
-    float _velocitySensitivity;
-
-    // The amount of vibrato to apply.
-    float _vibrato;
-
-    // Amount of waveshaping to add extra harmonics.
-    float _richness;
-
-    // How much to mix the modulator waveform into the final sound by itself.
-    // Normally the modulator is only used to change the carrier, but for some
-    // extra snazz you can make the modulator waveform audible as well.
-    float _modMix;
-
-    // Phase increment for the LFO.
-    float _lfoInc;
-
-    // === MIDI CC values ===
-
-    // Status of the damper pedal: 64 = pressed, 0 = released.
-    int _sustain;
-
-    // Output gain in linear units. Can be changed by MIDI CC 7.
-    float _volume;
-
-    // Modulation wheel value. Used to add more vibrato.
-    float _modWheel;
-
-    // Pitch bend value.
-    float _pitchBend;
+    // The host's sample rate and largest block, as given to prepareToPlay().
+    float _sampleRate;
+    int _maxBlockSize = 0;
+    
+    // Requested internal rate, and whether the engine renders at it now.
+    // Only changed while processing is suspended.
+    std::atomic<int> _internalRate { 0 };
+    bool _resampling = false;
+    
+    // Converters from the internal rate to the host's, one per precision.
+    DX10Resampler<float> _resampler;
+    DX10Resampler<double> _resamplerDouble;
+    
+    // Requested note cache size, and the caches; only the engine that
+    // renders has memory in its own.
+    std::atomic<int> _noteCacheSize { 0 };
+    DX10NoteCache<float> _noteCache;
+    DX10NoteCache<double> _noteCacheDouble;
+    
+    // Voices, envelopes and rendering; this class feeds it parameters and MIDI.
+    // The double engine renders when the host processes in double precision.
+    DX10Engine _engine;
+    DX10EngineDouble _engineDouble;
     
-    // Portamento/Glide settings (controlled by UI knob + can be overridden by MIDI CC)
-    float _glideTime = 0.0f;         // From UI parameter (0-1)
-    float _portamentoTimeCC = -1.0f; // CC #5 override (-1 = use UI knob)
-    bool _portamentoOnCC = false;    // CC #65 override
-    float _portamentoRate = 1.0f;    // Calculated glide rate per sample
-    int _lastNote = -1;              // Last played note for portamento
+    // Each engine's MIDI, resampling and idle skipping, block by block.
+    DX10BlockRenderer<float> _blockRenderer { _engine, _resampler };
+    DX10BlockRenderer<double> _blockRendererDouble { _engineDouble, _resamplerDouble };
     
-    // Output section parameters
-    float _outputGain = 1.0f;  // 0dB default
-    float _saturation = 0.0f;
+    // Calls f with the engine for the host's processing precision.
+    template <typename Function>
+    void withEngine(Function&& f)
+    {
+        if (isUsingDoublePrecision())
+            f(_engineDouble);
+        else
+            f(_engine);
+    }
+    
+    // Requested channel mode; the audio thread brings the engine in line.
+    std::atomic<int> _channelMode { 0 };
+    
+    // Factory program of each MIDI channel in multi-timbral mode, or -1 to
+    // play channel 1's patch. Entry 0 is unused: channel 1 is the parameters.
+    std::atomic<int> _channelPrograms[NCHANNELS];
+    
+    // Set when the channel programs were restored, so the audio thread
+    // applies them all at the next block.
+    std::atomic<bool> _channelProgramsChanged { false };
+    
+    // Tuning tables are handed to the audio thread like parameter snapshots:
+    // the message thread fills a slot that is neither published nor in use.
+    DX10Tuning _tuningSlots[3];
+    std::atomic<const DX10Tuning*> _publishedTuning { nullptr };
+    std::atomic<const DX10Tuning*> _tuningInUse { nullptr };
+    
+    // Scala texts of the current tuning (message thread only).
+    juce::String _tuningScale, _tuningMapping;
+    
+    // The engine's tuning as the audio thread knows it, so MIDI Tuning
+    // Standard messages can change single notes of it.
+    DX10Tuning _midiTuning;
     
     // Flag to prevent setCurrentProgram from overwriting restored state
     bool _isRestoringState = false;
     
     // Pointer to spectrum analyzer (set by editor)
     SpectrumAnalyzer* spectrumAnalyzer = nullptr;
+    
+    BlockTelemetry _telemetry;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DX10AudioProcessor);
 };
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include <cstring>
+
+// Binary preset bank (.dx10bank). Holds thousands of presets in a single file
+// that is memory-mapped and read in place, with no XML parsing and one file open.
+//
+// Layout (all integers little-endian, offsets in bytes from the start of the file):
+//
+//   Header              magic "DXBK", version, preset count, parameter count,
+//                       parameter directory offset, record offset,
+//                       string table offset, string table size
+//   Parameter directory one string reference per parameter ID
+//   Records             fixed size: name, folder and tags string references,
+//                       then one float per parameter in directory order
+//   String table        UTF-8 text referenced by (offset, length) pairs
+class PresetBank
+{
+public:
+    static constexpr juce::uint32 magic = 0x4b425844;  // "DXBK"
+    static constexpr juce::uint32 currentVersion = 1;
+
+    static juce::String getBankExtension() { return ".dx10bank"; }
+
+    // One preset as written to a bank. Values follow the bank's parameter ID order.
+    struct Entry
+    {
+        juce::String name;
+        juce::String folder;   // sub-folder the preset came from, '/' separated
+        juce::String tags;     // comma separated
+        std::vector<float> values;
+    };
+
+    // Maps and validates a bank file. Returns nullptr if it is not a readable bank.
+    static std::unique_ptr<PresetBank> open(const juce::File& file)
+    {
+        std::unique_ptr<PresetBank> bank(new PresetBank(file));
+        if (!bank->isValid())
+            return nullptr;
+        return bank;
+    }
+
+    const juce::File& getFile() const { return bankFile; }
+    juce::uint32 getVersion() const { return version; }
+    int getNumPresets() const { return static_cast<int>(numPresets); }
+    int getNumParameters() const { return static_cast<int>(numParameters); }
+
+    juce::String getParameterID(int parameter) const
+    {
+        return readString(base + parameterDirectoryOffset + static_cast<size_t>(parameter) * stringRefSize);
+    }
+
+    juce::String getPresetName(int index) const   { return readString(getRecord(index)); }
+    juce::String getPresetFolder(int index) const { return readString(getRecord(index) + stringRefSize); }
+    juce::String getPresetTags(int index) const   { return readString(getRecord(index) + stringRefSize * 2); }
+
+    float getParameterValue(int index, int parameter) const
+    {
+        return readFloat(getRecord(index) + recordHeaderSize + static_cast<size_t>(parameter) * sizeof(float));
+    }
+
+    // Serialises the given presets into a new bank file.
+    static bool write(const juce::File& file, const juce::StringArray& parameterIds, const std::vector<Entry>& presets)
+    {
+        juce::MemoryOutputStream strings;
+        auto addString = [&strings](juce::MemoryOutputStream& out, const juce::String& text)
+        {
+            auto utf8 = text.toUTF8();
+            auto length = utf8.sizeInBytes() - 1;
+            out.writeInt(static_cast<int>(strings.getDataSize()));
+            out.writeInt(static_cast<int>(length));
+            strings.write(utf8.getAddress(), length);
+        };
+
+        const auto numParams = static_cast<size_t>(parameterIds.size());
+        const auto recordSize = recordHeaderSize + numParams * sizeof(float);
+        const auto directoryOffset = headerSize;
+        const auto recordsOffset = directoryOffset + numParams * stringRefSize;
+        const auto stringsOffset = recordsOffset + presets.size() * recordSize;
+
+        juce::MemoryOutputStream directory;
+        for (const auto& id : parameterIds)
+            addString(directory, id);
+
+        juce::MemoryOutputStream records;
+        for (const auto& preset : presets)
+        {
+            addString(records, preset.name);
+            addString(records, preset.folder);
+            addString(records, preset.tags);
+            for (size_t p = 0; p < numParams; ++p)
+                records.writeFloat(p < preset.values.size() ? preset.values[p] : 0.0f);
+        }
+
+        juce::MemoryOutputStream out;
+        out.writeInt(static_cast<int>(magic));
+        out.writeInt(static_cast<int>(currentVersion));
+        out.writeInt(static_cast<int>(presets.size()));
+        out.writeInt(static_cast<int>(numParams));
+        out.writeInt(static_cast<int>(directoryOffset));
+        out.writeInt(static_cast<int>(recordsOffset));
+        out.writeInt(static_cast<int>(stringsOffset));
+        out.writeInt(static_cast<int>(strings.getDataSize()));
+        out << directory.getMemoryBlock() << records.getMemoryBlock() << strings.getMemoryBlock();
+
+        jassert(out.getDataSize() == stringsOffset + strings.getDataSize());
+
+        file.getParentDirectory().createDirectory();
+        return file.replaceWithData(out.getData(), out.getDataSize());
+    }
+
+private:
+    static constexpr size_t headerSize = 32;
+    static constexpr size_t stringRefSize = 8;
+    static constexpr size_t recordHeaderSize = stringRefSize * 3;
+
+    explicit PresetBank(const juce::File& file)
+        : bankFile(file), mappedFile(file, juce::MemoryMappedFile::readOnly)
+    {
+        base = static_cast<const char*>(mappedFile.getData());
+        size = mappedFile.getSize();
+
+        if (base == nullptr || size < headerSize)
+            return;
+
+        if (readInt(base) != magic)
+            return;
+
+        version = readInt(base + 4);
+        numPresets = readInt(base + 8);
+        numParameters = readInt(base + 12);
+        parameterDirectoryOffset = readInt(base + 16);
+        recordsOffset = readInt(base + 20);
+        stringsOffset = readInt(base + 24);
+        stringsSize = readInt(base + 28);
+        recordSize = recordHeaderSize + numParameters * sizeof(float);
+
+        valid = version >= 1 && version <= currentVersion
+             && parameterDirectoryOffset + static_cast<size_t>(numParameters) * stringRefSize <= size
+             && recordsOffset + static_cast<size_t>(numPresets) * recordSize <= size
+             && stringsOffset + static_cast<size_t>(stringsSize) <= size;
+    }
+
+    bool isValid() const { return valid; }
+
+    const char* getRecord(int index) const
+    {
+        jassert(index >= 0 && index < getNumPresets());
+        return base + recordsOffset + static_cast<size_t>(index) * recordSize;
+    }
+
+    static juce::uint32 readInt(const char* p) { return juce::ByteOrder::littleEndianInt(p); }
+
+    static float readFloat(const char* p)
+    {
+        auto bits = readInt(p);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    juce::String readString(const char* ref) const
+    {
+        const auto offset = readInt(ref);
+        const auto length = readInt(ref + 4);
+        if (static_cast<size_t>(offset) + length > stringsSize)
+            return {};
+        return juce::String::fromUTF8(base + stringsOffset + offset, static_cast<int>(length));
+    }
+
+    juce::File bankFile;
+    juce::MemoryMappedFile mappedFile;
+    const char* base = nullptr;
+    size_t size = 0;
+    bool valid = false;
+
+    juce::uint32 version = 0, numPresets = 0, numParameters = 0;
+    size_t parameterDirectoryOffset = 0, recordsOffset = 0, stringsOffset = 0, stringsSize = 0, recordSize = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetBank)
+};
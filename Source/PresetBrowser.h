@@ -0,0 +1,179 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PresetSearchIndex.h"
+#include <functional>
+
+// Search field plus result list over a PresetSearchIndex. The list is a
+// juce::ListBox, so only the visible rows are ever painted, however many
+// presets match.
+class PresetBrowser : public juce::Component,
+                      private juce::ListBoxModel,
+                      private juce::TextEditor::Listener,
+                      private juce::KeyListener
+{
+public:
+    PresetBrowser()
+    {
+        searchField.setTextToShowWhenEmpty("Search presets...", juce::Colour(0xFF666677));
+        searchField.setColour(juce::TextEditor::backgroundColourId, juce::Colour(0xFF1E1E28));
+        searchField.setColour(juce::TextEditor::textColourId, juce::Colour(0xFFFFFFFF));
+        searchField.setColour(juce::TextEditor::outlineColourId, juce::Colour(0xFF3A3A45));
+        searchField.setColour(juce::TextEditor::focusedOutlineColourId, juce::Colour(0xFF00D4AA));
+        searchField.setEscapeAndReturnKeysConsumed(false);
+        searchField.addListener(this);
+        searchField.addKeyListener(this);
+        addAndMakeVisible(searchField);
+
+        resultList.setModel(this);
+        resultList.setRowHeight(22);
+        resultList.setColour(juce::ListBox::backgroundColourId, juce::Colour(0xFF15151D));
+        addAndMakeVisible(resultList);
+    }
+
+    ~PresetBrowser() override
+    {
+        searchField.removeKeyListener(this);
+        searchField.removeListener(this);
+    }
+
+    // Called with the combo box ID of the chosen preset.
+    std::function<void(int presetId)> onPresetChosen;
+    std::function<void()> onDismiss;
+
+    // Swap in a freshly built index and re-run the current query against it.
+    void setIndex(std::shared_ptr<const PresetSearchIndex> newIndex)
+    {
+        index = std::move(newIndex);
+        runQuery();
+    }
+
+    void focusSearchField()
+    {
+        searchField.selectAll();
+        searchField.grabKeyboardFocus();
+    }
+
+    void paint(juce::Graphics& g) override
+    {
+        g.setColour(juce::Colour(0xFF1A1A22));
+        g.fillRoundedRectangle(getLocalBounds().toFloat(), 8.0f);
+        g.setColour(juce::Colour(0xFF00D4AA).withAlpha(0.5f));
+        g.drawRoundedRectangle(getLocalBounds().toFloat().reduced(0.5f), 8.0f, 1.0f);
+
+        g.setFont(12.0f);
+        g.setColour(juce::Colour(0xFF666677));
+        g.drawText(juce::String(static_cast<int>(results.size())) + " presets", statusBounds, juce::Justification::centredRight);
+    }
+
+    void resized() override
+    {
+        auto bounds = getLocalBounds().reduced(8);
+        auto top = bounds.removeFromTop(26);
+        statusBounds = top.removeFromRight(90);
+        searchField.setBounds(top.withTrimmedRight(8));
+        bounds.removeFromTop(6);
+        resultList.setBounds(bounds);
+    }
+
+    bool keyPressed(const juce::KeyPress& key) override
+    {
+        return handleKey(key);
+    }
+
+private:
+    // Arrow keys move through the results while typing in the search field
+    bool keyPressed(const juce::KeyPress& key, juce::Component*) override
+    {
+        return handleKey(key);
+    }
+
+    bool handleKey(const juce::KeyPress& key)
+    {
+        const int row = resultList.getSelectedRow();
+        if (key == juce::KeyPress::downKey)
+        {
+            selectRow(juce::jmin(row + 1, getNumRows() - 1));
+            return true;
+        }
+        if (key == juce::KeyPress::upKey)
+        {
+            selectRow(juce::jmax(row - 1, 0));
+            return true;
+        }
+        if (key == juce::KeyPress::returnKey)
+        {
+            choose(row >= 0 ? row : 0);
+            return true;
+        }
+        if (key == juce::KeyPress::escapeKey)
+        {
+            if (onDismiss) onDismiss();
+            return true;
+        }
+        return false;
+    }
+
+    void runQuery()
+    {
+        results = index != nullptr ? index->search(searchField.getText()) : std::vector<int>();
+        resultList.updateContent();
+        resultList.scrollToEnsureRowIsOnscreen(0);
+        selectRow(0);
+        repaint(statusBounds);
+    }
+
+    void selectRow(int row)
+    {
+        if (row >= 0 && row < getNumRows())
+            resultList.selectRow(row);
+        else
+            resultList.deselectAllRows();
+    }
+
+    void choose(int row)
+    {
+        if (index != nullptr && row >= 0 && row < getNumRows() && onPresetChosen)
+            onPresetChosen(index->getDocument(results[static_cast<size_t>(row)]).presetId);
+    }
+
+    // ListBoxModel
+    int getNumRows() override { return static_cast<int>(results.size()); }
+
+    void paintListBoxItem(int row, juce::Graphics& g, int width, int height, bool selected) override
+    {
+        if (index == nullptr || row < 0 || row >= getNumRows())
+            return;
+
+        const auto& doc = index->getDocument(results[static_cast<size_t>(row)]);
+        if (selected)
+        {
+            g.setColour(juce::Colour(0xFF00D4AA));
+            g.fillRect(0, 0, width, height);
+        }
+
+        auto area = juce::Rectangle<int>(0, 0, width, height).reduced(8, 0);
+        g.setFont(13.0f);
+        g.setColour(selected ? juce::Colour(0xFF000000) : juce::Colour(0xFFFFFFFF));
+        g.drawText(doc.name, area.removeFromLeft(width / 2), juce::Justification::centredLeft, true);
+
+        g.setFont(11.0f);
+        g.setColour(selected ? juce::Colour(0xFF1A1A22) : juce::Colour(0xFF888899));
+        auto detail = doc.tags.isNotEmpty() ? doc.folder + "  -  " + doc.tags : doc.folder;
+        g.drawText(detail, area, juce::Justification::centredRight, true);
+    }
+
+    void listBoxItemDoubleClicked(int row, const juce::MouseEvent&) override { choose(row); }
+    void returnKeyPressed(int row) override { choose(row); }
+
+    // TextEditor::Listener
+    void textEditorTextChanged(juce::TextEditor&) override { runQuery(); }
+
+    juce::TextEditor searchField;
+    juce::ListBox resultList;
+    juce::Rectangle<int> statusBounds;
+    std::shared_ptr<const PresetSearchIndex> index;
+    std::vector<int> results;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetBrowser)
+};
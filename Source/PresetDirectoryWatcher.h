@@ -0,0 +1,703 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include <map>
+#include <functional>
+#include <algorithm>
+
+#if JUCE_LINUX
+ #include <sys/inotify.h>
+ #include <poll.h>
+ #include <unistd.h>
+#elif JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+#elif JUCE_MAC
+ #include <CoreServices/CoreServices.h>
+ #include <dispatch/dispatch.h>
+#endif
+
+// A single change to the preset directory tree. Directory entries describe a
+// whole subtree (e.g. a folder of presets moved in by a sync tool).
+struct PresetChange
+{
+    enum class Type { added, removed, renamed, rescanRequired };
+
+    Type type = Type::added;
+    juce::File file;      // new location (added / renamed) or old location (removed)
+    juce::File oldFile;   // previous location, only set for renamed
+    bool isDirectory = false;
+
+    PresetChange() = default;
+    PresetChange(Type t, const juce::File& f, const juce::File& old = {}, bool dir = false)
+        : type(t), file(f), oldFile(old), isDirectory(dir) {}
+};
+
+// Watches the preset directory on a background thread and reports add, remove
+// and rename deltas on the message thread. Uses inotify on Linux,
+// ReadDirectoryChangesW on Windows and FSEvents on macOS. Elsewhere, or when
+// the native API is unavailable, it polls: only directories whose
+// modification time changed are listed again.
+class PresetDirectoryWatcher : private juce::Thread,
+                               private juce::AsyncUpdater
+{
+public:
+    PresetDirectoryWatcher() : juce::Thread("DX10 Preset Watcher") {}
+
+    ~PresetDirectoryWatcher() override
+    {
+        stopWatching();
+    }
+
+    // Called on the message thread with every change batched since the last call.
+    std::function<void(const std::vector<PresetChange>&)> onChanges;
+
+    // presetExtensions is a semicolon separated list, e.g. ".dx10;.dx10bank"
+    void startWatching(const juce::File& directory, const juce::String& presetExtensions)
+    {
+        stopWatching();
+        if (!directory.isDirectory())
+            return;
+
+        watchedDirectory = directory;
+        extensions = presetExtensions;
+        wildcard = "*" + juce::StringArray::fromTokens(presetExtensions, ";", {}).joinIntoString(";*");
+        startThread(juce::Thread::Priority::low);
+    }
+
+    void stopWatching()
+    {
+        stopThread(2000);
+        cancelPendingUpdate();
+
+        const juce::ScopedLock sl(changeLock);
+        pendingChanges.clear();
+    }
+
+    static constexpr int pollIntervalMs = 5000;
+
+private:
+    void run() override
+    {
+       #if JUCE_LINUX
+        if (runInotify())
+            return;
+       #elif JUCE_WINDOWS
+        if (runReadDirectoryChanges())
+            return;
+       #elif JUCE_MAC
+        if (runFSEvents())
+            return;
+       #endif
+        runPolling();
+    }
+
+    void postChanges(std::vector<PresetChange>&& changes)
+    {
+        if (changes.empty())
+            return;
+
+        {
+            const juce::ScopedLock sl(changeLock);
+            for (auto& change : changes)
+                pendingChanges.push_back(std::move(change));
+        }
+        triggerAsyncUpdate();
+    }
+
+    void handleAsyncUpdate() override
+    {
+        std::vector<PresetChange> changes;
+        {
+            const juce::ScopedLock sl(changeLock);
+            changes.swap(pendingChanges);
+        }
+
+        if (!changes.empty() && onChanges)
+            onChanges(changes);
+    }
+
+    bool isPresetFile(const juce::File& file) const
+    {
+        return file.hasFileExtension(extensions);
+    }
+
+    // A file or folder moved from oldFile to file, as far as the presets are
+    // concerned. An empty oldFile means it moved in from outside the tree, an
+    // empty file that it moved out.
+    void addMove(std::vector<PresetChange>& changes, const juce::File& oldFile, const juce::File& file, bool isDirectory) const
+    {
+        if (oldFile == juce::File() || file == juce::File())
+        {
+            const bool movedIn = oldFile == juce::File();
+            const auto& moved = movedIn ? file : oldFile;
+            if (isDirectory || isPresetFile(moved))
+                changes.emplace_back(movedIn ? PresetChange::Type::added : PresetChange::Type::removed, moved, juce::File(), isDirectory);
+        }
+        else if (isDirectory)
+            changes.emplace_back(PresetChange::Type::renamed, file, oldFile, true);
+        else if (isPresetFile(file) && isPresetFile(oldFile))
+            changes.emplace_back(PresetChange::Type::renamed, file, oldFile);
+        else if (isPresetFile(file))
+            changes.emplace_back(PresetChange::Type::added, file);
+        else if (isPresetFile(oldFile))
+            changes.emplace_back(PresetChange::Type::removed, oldFile);
+    }
+
+    // === Polling fallback ===
+
+    struct FileStamp
+    {
+        juce::int64 size = 0;
+        juce::int64 modified = 0;
+
+        bool operator==(const FileStamp& other) const { return size == other.size && modified == other.modified; }
+    };
+
+    using Snapshot = std::map<juce::String, FileStamp>;
+
+    // What the last poll saw in one directory. Adding, removing or renaming
+    // an entry changes the directory's modification time, so a poll only
+    // lists the directories whose time moved instead of the whole tree.
+    struct DirectoryState
+    {
+        juce::int64 modified = 0;
+        Snapshot files;
+        juce::StringArray subdirectories;
+    };
+
+    // Lists a directory and everything below it into directories. Files found
+    // go into found.
+    void scanDirectory(const juce::File& dir, Snapshot& found)
+    {
+        auto& state = directories[dir.getFullPathName()];
+        state = {};
+        state.modified = dir.getLastModificationTime().toMilliseconds();
+
+        for (const auto& file : dir.findChildFiles(juce::File::findFiles, false, wildcard))
+        {
+            const FileStamp stamp { file.getSize(), file.getLastModificationTime().toMilliseconds() };
+            state.files[file.getFullPathName()] = stamp;
+            found[file.getFullPathName()] = stamp;
+        }
+
+        juce::Array<juce::File> children;
+        for (const auto& child : dir.findChildFiles(juce::File::findDirectories, false))
+        {
+            if (!child.getFileName().startsWithChar('.'))
+            {
+                state.subdirectories.add(child.getFullPathName());
+                children.add(child);
+            }
+        }
+        for (const auto& child : children)
+            scanDirectory(child, found);
+    }
+
+    // Forgets a directory and everything below it. Its files go into lost.
+    void forgetDirectory(const juce::String& path, Snapshot& lost)
+    {
+        auto it = directories.find(path);
+        if (it == directories.end())
+            return;
+
+        const auto state = std::move(it->second);
+        directories.erase(it);
+        for (const auto& entry : state.files)
+            lost[entry.first] = entry.second;
+        for (const auto& child : state.subdirectories)
+            forgetDirectory(child, lost);
+    }
+
+    // Lists one directory again; new subdirectories are scanned in full.
+    void rescanDirectory(const juce::String& path, Snapshot& found, Snapshot& lost)
+    {
+        const juce::File dir(path);
+        if (!dir.isDirectory())
+            return;  // its parent changed too and forgets it
+
+        auto& state = directories[path];
+        state.modified = dir.getLastModificationTime().toMilliseconds();
+
+        Snapshot files;
+        for (const auto& file : dir.findChildFiles(juce::File::findFiles, false, wildcard))
+            files[file.getFullPathName()] = { file.getSize(), file.getLastModificationTime().toMilliseconds() };
+
+        for (const auto& entry : state.files)
+            if (files.find(entry.first) == files.end())
+                lost[entry.first] = entry.second;
+        for (const auto& entry : files)
+            if (state.files.find(entry.first) == state.files.end())
+                found[entry.first] = entry.second;
+        state.files = std::move(files);
+
+        juce::StringArray subdirectories;
+        for (const auto& child : dir.findChildFiles(juce::File::findDirectories, false))
+            if (!child.getFileName().startsWithChar('.'))
+                subdirectories.add(child.getFullPathName());
+
+        const auto previous = state.subdirectories;
+        state.subdirectories = subdirectories;
+        for (const auto& child : previous)
+            if (!subdirectories.contains(child))
+                forgetDirectory(child, lost);
+        for (const auto& child : subdirectories)
+            if (!previous.contains(child))
+                scanDirectory(juce::File(child), found);
+    }
+
+    void runPolling()
+    {
+        directories.clear();
+        Snapshot initial;
+        scanDirectory(watchedDirectory, initial);
+
+        while (!threadShouldExit())
+        {
+            wait(pollIntervalMs);
+            if (threadShouldExit())
+                break;
+
+            juce::StringArray changedDirectories;
+            for (const auto& entry : directories)
+                if (juce::File(entry.first).getLastModificationTime().toMilliseconds() != entry.second.modified)
+                    changedDirectories.add(entry.first);
+
+            Snapshot found, lost;
+            for (const auto& path : changedDirectories)
+                if (directories.find(path) != directories.end())
+                    rescanDirectory(path, found, lost);
+
+            std::vector<PresetChange> changes;
+            for (const auto& entry : found)
+            {
+                // A file that vanished with the same size and timestamp was renamed.
+                auto match = std::find_if(lost.begin(), lost.end(),
+                                          [&entry](const auto& r) { return r.second == entry.second; });
+                if (match != lost.end())
+                {
+                    changes.emplace_back(PresetChange::Type::renamed, juce::File(entry.first), juce::File(match->first));
+                    lost.erase(match);
+                }
+                else
+                {
+                    changes.emplace_back(PresetChange::Type::added, juce::File(entry.first));
+                }
+            }
+
+            for (const auto& entry : lost)
+                changes.emplace_back(PresetChange::Type::removed, juce::File(entry.first));
+
+            postChanges(std::move(changes));
+        }
+        directories.clear();
+    }
+
+    std::map<juce::String, DirectoryState> directories;
+
+   #if JUCE_LINUX
+    // === inotify ===
+
+    static constexpr uint32_t watchMask = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+
+    void addWatchRecursive(int fd, const juce::File& dir)
+    {
+        if (dir.getFileName().startsWithChar('.'))
+            return;
+
+        int wd = inotify_add_watch(fd, dir.getFullPathName().toRawUTF8(), watchMask | IN_ONLYDIR);
+        if (wd < 0)
+            return;
+
+        watches[wd] = dir;
+        for (const auto& child : dir.findChildFiles(juce::File::findDirectories, false))
+            addWatchRecursive(fd, child);
+    }
+
+    void removeWatchesUnder(int fd, const juce::File& dir)
+    {
+        for (auto it = watches.begin(); it != watches.end();)
+        {
+            if (it->second == dir || it->second.isAChildOf(dir))
+            {
+                inotify_rm_watch(fd, it->first);
+                it = watches.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    void renameWatchesUnder(const juce::File& oldDir, const juce::File& newDir)
+    {
+        for (auto& entry : watches)
+        {
+            if (entry.second == oldDir)
+                entry.second = newDir;
+            else if (entry.second.isAChildOf(oldDir))
+                entry.second = newDir.getChildFile(entry.second.getRelativePathFrom(oldDir));
+        }
+    }
+
+    // Returns false if inotify could not be set up, so the caller can fall back to polling.
+    bool runInotify()
+    {
+        int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0)
+            return false;
+
+        watches.clear();
+        addWatchRecursive(fd, watchedDirectory);
+        if (watches.empty())
+        {
+            close(fd);
+            return false;
+        }
+
+        struct PendingMove { juce::File file; bool isDirectory; };
+        std::map<uint32_t, PendingMove> pendingMoves;
+
+        alignas(inotify_event) char buffer[8192];
+
+        while (!threadShouldExit())
+        {
+            pollfd pfd { fd, POLLIN, 0 };
+            if (poll(&pfd, 1, 250) <= 0)
+                continue;
+
+            std::vector<PresetChange> changes;
+
+            // Drain everything that is available so rename pairs land in one batch.
+            for (;;)
+            {
+                auto length = read(fd, buffer, sizeof(buffer));
+                if (length <= 0)
+                    break;
+
+                for (char* ptr = buffer; ptr < buffer + length;)
+                {
+                    const auto* event = reinterpret_cast<const inotify_event*>(ptr);
+                    ptr += sizeof(inotify_event) + event->len;
+
+                    if ((event->mask & IN_Q_OVERFLOW) != 0)
+                    {
+                        changes.emplace_back(PresetChange::Type::rescanRequired, watchedDirectory);
+                        continue;
+                    }
+
+                    auto dirIt = watches.find(event->wd);
+                    if (dirIt == watches.end() || event->len == 0)
+                        continue;
+
+                    auto file = dirIt->second.getChildFile(juce::String::fromUTF8(event->name));
+                    const bool isDir = (event->mask & IN_ISDIR) != 0;
+
+                    if (!isDir && !isPresetFile(file) && (event->mask & (IN_MOVED_FROM | IN_MOVED_TO)) == 0)
+                        continue;
+
+                    if ((event->mask & IN_MOVED_FROM) != 0)
+                    {
+                        pendingMoves[event->cookie] = { file, isDir };
+                    }
+                    else if ((event->mask & IN_MOVED_TO) != 0)
+                    {
+                        auto from = pendingMoves.find(event->cookie);
+                        if (from != pendingMoves.end())
+                        {
+                            const auto oldFile = from->second.file;
+                            pendingMoves.erase(from);
+
+                            if (isDir)
+                                renameWatchesUnder(oldFile, file);
+                            addMove(changes, oldFile, file, isDir);
+                        }
+                        else if (isDir)
+                        {
+                            addWatchRecursive(fd, file);
+                            changes.emplace_back(PresetChange::Type::added, file, juce::File(), true);
+                        }
+                        else if (isPresetFile(file))
+                        {
+                            changes.emplace_back(PresetChange::Type::added, file);
+                        }
+                    }
+                    else if ((event->mask & IN_CREATE) != 0)
+                    {
+                        // Files are reported once they are closed after writing.
+                        if (isDir)
+                        {
+                            addWatchRecursive(fd, file);
+                            changes.emplace_back(PresetChange::Type::added, file, juce::File(), true);
+                        }
+                    }
+                    else if ((event->mask & IN_CLOSE_WRITE) != 0)
+                    {
+                        changes.emplace_back(PresetChange::Type::added, file);
+                    }
+                    else if ((event->mask & IN_DELETE) != 0)
+                    {
+                        if (isDir)
+                            removeWatchesUnder(fd, file);
+                        changes.emplace_back(PresetChange::Type::removed, file, juce::File(), isDir);
+                    }
+                }
+            }
+
+            // Anything moved out of the tree without a matching destination is gone.
+            for (const auto& move : pendingMoves)
+            {
+                if (move.second.isDirectory)
+                {
+                    removeWatchesUnder(fd, move.second.file);
+                    changes.emplace_back(PresetChange::Type::removed, move.second.file, juce::File(), true);
+                }
+                else if (isPresetFile(move.second.file))
+                {
+                    changes.emplace_back(PresetChange::Type::removed, move.second.file);
+                }
+            }
+            pendingMoves.clear();
+
+            postChanges(std::move(changes));
+        }
+
+        close(fd);
+        watches.clear();
+        return true;
+    }
+
+    std::map<int, juce::File> watches;
+   #endif
+
+   #if JUCE_WINDOWS
+    // === ReadDirectoryChangesW ===
+
+    // Returns false if the directory could not be watched, so the caller can fall back to polling.
+    bool runReadDirectoryChanges()
+    {
+        HANDLE directory = CreateFileW(watchedDirectory.getFullPathName().toWideCharPointer(), FILE_LIST_DIRECTORY,
+                                       FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                                       FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+        if (directory == INVALID_HANDLE_VALUE)
+            return false;
+
+        OVERLAPPED overlapped {};
+        overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+
+        alignas(DWORD) char buffer[32768];
+        const DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME
+                           | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+
+        // The whole subtree is watched through the one handle
+        auto requestChanges = [&] {
+            ResetEvent(overlapped.hEvent);
+            return ReadDirectoryChangesW(directory, buffer, sizeof(buffer), TRUE, filter, nullptr, &overlapped, nullptr) != 0;
+        };
+
+        bool watching = overlapped.hEvent != nullptr && requestChanges();
+        if (!watching)
+        {
+            if (overlapped.hEvent != nullptr)
+                CloseHandle(overlapped.hEvent);
+            CloseHandle(directory);
+            return false;
+        }
+
+        juce::File renamedFrom;
+
+        while (!threadShouldExit())
+        {
+            if (WaitForSingleObject(overlapped.hEvent, 250) != WAIT_OBJECT_0)
+                continue;
+
+            std::vector<PresetChange> changes;
+            DWORD length = 0;
+            if (!GetOverlappedResult(directory, &overlapped, &length, FALSE) || length == 0)
+            {
+                // More changed than the buffer holds, and the details are lost
+                changes.emplace_back(PresetChange::Type::rescanRequired, watchedDirectory);
+            }
+            else
+            {
+                for (DWORD offset = 0;;)
+                {
+                    const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(buffer + offset);
+                    const auto file = watchedDirectory.getChildFile(juce::String(info->FileName, info->FileNameLength / sizeof(WCHAR)));
+
+                    switch (info->Action)
+                    {
+                        case FILE_ACTION_ADDED:
+                            if (file.isDirectory())
+                                changes.emplace_back(PresetChange::Type::added, file, juce::File(), true);
+                            else if (isPresetFile(file))
+                                changes.emplace_back(PresetChange::Type::added, file);
+                            break;
+
+                        case FILE_ACTION_MODIFIED:
+                            // Folders are reported as modified whenever their contents change
+                            if (isPresetFile(file) && file.existsAsFile())
+                                changes.emplace_back(PresetChange::Type::added, file);
+                            break;
+
+                        case FILE_ACTION_REMOVED:
+                            // What was removed can no longer be asked whether it was a folder
+                            changes.emplace_back(PresetChange::Type::removed, file, juce::File(), !isPresetFile(file));
+                            break;
+
+                        case FILE_ACTION_RENAMED_OLD_NAME:
+                            renamedFrom = file;
+                            break;
+
+                        case FILE_ACTION_RENAMED_NEW_NAME:
+                            addMove(changes, renamedFrom, file, file.isDirectory());
+                            renamedFrom = juce::File();
+                            break;
+
+                        default:
+                            break;
+                    }
+
+                    if (info->NextEntryOffset == 0)
+                        break;
+                    offset += info->NextEntryOffset;
+                }
+            }
+
+            // Ask for the next batch before reporting this one, so nothing is missed
+            watching = requestChanges();
+            if (!watching)
+                changes.emplace_back(PresetChange::Type::rescanRequired, watchedDirectory);
+            postChanges(std::move(changes));
+            if (!watching)
+                break;
+        }
+
+        // The read must be finished before its buffer goes away
+        if (watching)
+        {
+            DWORD length = 0;
+            CancelIoEx(directory, &overlapped);
+            GetOverlappedResult(directory, &overlapped, &length, TRUE);
+        }
+        CloseHandle(overlapped.hEvent);
+        CloseHandle(directory);
+
+        // The directory went away or can no longer be read; polling takes over
+        return watching || threadShouldExit();
+    }
+   #endif
+
+   #if JUCE_MAC
+    // === FSEvents ===
+
+    // Returns false if the stream could not be started, so the caller can fall back to polling.
+    bool runFSEvents()
+    {
+        CFStringRef path = CFStringCreateWithCString(nullptr, watchedDirectory.getFullPathName().toRawUTF8(), kCFStringEncodingUTF8);
+        CFArrayRef paths = CFArrayCreate(nullptr, reinterpret_cast<const void**>(&path), 1, &kCFTypeArrayCallBacks);
+        FSEventStreamContext context { 0, this, nullptr, nullptr, nullptr };
+        FSEventStreamRef stream = FSEventStreamCreate(nullptr, &PresetDirectoryWatcher::handleFSEvents, &context, paths,
+                                                      kFSEventStreamEventIdSinceNow, 0.2,
+                                                      kFSEventStreamCreateFlagFileEvents | kFSEventStreamCreateFlagNoDefer
+                                                      | kFSEventStreamCreateFlagWatchRoot);
+        CFRelease(paths);
+        CFRelease(path);
+        if (stream == nullptr)
+            return false;
+
+        // Events are delivered on a queue of their own; this thread only waits
+        dispatch_queue_t queue = dispatch_queue_create("DX10 Preset Watcher", DISPATCH_QUEUE_SERIAL);
+        FSEventStreamSetDispatchQueue(stream, queue);
+
+        const bool started = FSEventStreamStart(stream);
+        if (started)
+        {
+            while (!threadShouldExit())
+                wait(250);
+            FSEventStreamStop(stream);
+        }
+        FSEventStreamInvalidate(stream);
+        FSEventStreamRelease(stream);
+
+        // Let a callback that is still running finish before the watcher can go away
+        dispatch_sync_f(queue, nullptr, [](void*) {});
+        dispatch_release(queue);
+        return started;
+    }
+
+    static void handleFSEvents(ConstFSEventStreamRef, void* info, size_t numEvents, void* eventPaths,
+                               const FSEventStreamEventFlags* eventFlags, const FSEventStreamEventId*)
+    {
+        auto& watcher = *static_cast<PresetDirectoryWatcher*>(info);
+        const auto* const* paths = static_cast<const char* const*>(eventPaths);
+        const FSEventStreamEventFlags lostEvents = kFSEventStreamEventFlagMustScanSubDirs | kFSEventStreamEventFlagUserDropped
+                                                 | kFSEventStreamEventFlagKernelDropped | kFSEventStreamEventFlagRootChanged;
+
+        std::vector<PresetChange> changes;
+        juce::File renamedFrom;
+        bool renamedFromDirectory = false;
+
+        for (size_t i = 0; i < numEvents; ++i)
+        {
+            const auto flags = eventFlags[i];
+            const juce::File file(juce::String::fromUTF8(paths[i]));
+            const bool isDir = (flags & kFSEventStreamEventFlagItemIsDir) != 0;
+            const bool exists = isDir ? file.isDirectory() : file.existsAsFile();
+
+            if ((flags & lostEvents) != 0)
+            {
+                changes.emplace_back(PresetChange::Type::rescanRequired, watcher.watchedDirectory);
+                continue;
+            }
+
+            if ((flags & kFSEventStreamEventFlagItemRenamed) != 0)
+            {
+                // Both ends of a move are reported, the old path first. Whichever
+                // no longer exists is the old one.
+                if (!exists)
+                {
+                    if (renamedFrom != juce::File())
+                        watcher.addMove(changes, renamedFrom, {}, renamedFromDirectory);
+                    renamedFrom = file;
+                    renamedFromDirectory = isDir;
+                }
+                else
+                {
+                    watcher.addMove(changes, renamedFrom, file, isDir);
+                    renamedFrom = juce::File();
+                }
+                continue;
+            }
+
+            // Flags of events close together are merged, so what is on disk decides
+            if (exists)
+            {
+                if (isDir ? (flags & kFSEventStreamEventFlagItemCreated) != 0 : watcher.isPresetFile(file))
+                    changes.emplace_back(PresetChange::Type::added, file, juce::File(), isDir);
+            }
+            else if ((flags & kFSEventStreamEventFlagItemRemoved) != 0 && (isDir || watcher.isPresetFile(file)))
+            {
+                changes.emplace_back(PresetChange::Type::removed, file, juce::File(), isDir);
+            }
+        }
+
+        // Moved out of the tree
+        if (renamedFrom != juce::File())
+            watcher.addMove(changes, renamedFrom, {}, renamedFromDirectory);
+
+        watcher.postChanges(std::move(changes));
+    }
+   #endif
+
+    juce::File watchedDirectory;
+    juce::String extensions, wildcard;
+    juce::CriticalSection changeLock;
+    std::vector<PresetChange> pendingChanges;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetDirectoryWatcher)
+};
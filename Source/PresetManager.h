@@ -2,6 +2,13 @@
 
 #include <JuceHeader.h>
 #include <vector>
+#include <algorithm>
+#include <map>
+#include <functional>
+#include "PluginProcessor.h"
+#include "PresetDirectoryWatcher.h"
+#include "PresetBank.h"
+#include "PresetPrefetcher.h"
 
 // Forward declare structs outside the class to avoid template issues
 struct PresetItem
@@ -22,16 +29,27 @@ struct FlatPresetItem
     juce::File file;
     bool isFolder = false;
     int depth = 0;
+    int bankIndex = -1;  // index inside a .dx10bank file, -1 for single preset files
     
     FlatPresetItem() = default;
-    FlatPresetItem(const juce::String& name, const juce::File& f, bool folder, int d)
-        : displayName(name), file(f), isFolder(folder), depth(d) {}
+    FlatPresetItem(const juce::String& name, const juce::File& f, bool folder, int d, int bank = -1)
+        : displayName(name), file(f), isFolder(folder), depth(d), bankIndex(bank) {}
+    
+    // Unique key for this preset (bank entries share their bank's file)
+    juce::String getKey() const
+    {
+        return bankIndex >= 0 ? file.getFullPathName() + "#" + juce::String(bankIndex) : file.getFullPathName();
+    }
 };
 
-class PresetManager
+class PresetManager : private juce::Timer,
+                      private juce::AsyncUpdater
 {
 public:
-    PresetManager(juce::AudioProcessorValueTreeState& apvts) : valueTreeState(apvts)
+    PresetManager(DX10AudioProcessor& p)
+        : processor(p), valueTreeState(p.apvts),
+          prefetcher([stateType = p.apvts.state.getType().toString()](const juce::File& file, ParameterSnapshot& snapshot)
+                     { return parsePresetFile(file, stateType, snapshot); })
     {
         loadSettings();
         
@@ -49,8 +67,22 @@ public:
             presetDirectory.createDirectory();
     }
 
+    ~PresetManager() override
+    {
+        scanner.reset();
+        cancelPendingUpdate();
+        
+        // Flush a pending settings write
+        if (isTimerRunning())
+            timerCallback();
+    }
+
     static juce::String getPresetExtension() { return ".dx10"; }
     
+    // Everything the preset browser indexes: single presets and preset banks
+    static juce::String getPresetFileExtensions() { return getPresetExtension() + ";" + PresetBank::getBankExtension(); }
+    static juce::String getPresetFileWildcard() { return "*" + getPresetExtension() + ";*" + PresetBank::getBankExtension(); }
+    
     static juce::File getDefaultPresetDirectory()
     {
         return juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
@@ -87,10 +119,13 @@ public:
     
     juce::String getLastLoadedPreset() const { return lastLoadedPreset; }
     
-    void setLastLoadedPreset(const juce::String& presetPath)
+    void setLastLoadedPreset(const juce::String& presetPath, int bankIndex = -1)
     {
         lastLoadedPreset = presetPath;
-        saveSettings();
+        lastLoadedBankIndex = bankIndex;
+        
+        // Written a little later so stepping through presets never waits on the disk
+        startTimer(settingsSaveDelayMs);
     }
 
     bool savePresetToFile(const juce::File& file)
@@ -122,46 +157,74 @@ public:
         return xml->writeTo(file);
     }
 
-    bool loadPresetFromFile(const juce::File& file)
+    // Parse a preset file into a snapshot. Internal tracking parameters
+    // (PresetIndex, SelectedPresetId) are not part of a snapshot and are set by
+    // the caller. Safe to call from any thread.
+    static bool parsePresetFile(const juce::File& file, const juce::String& stateType, ParameterSnapshot& snapshot)
     {
         if (!file.existsAsFile())
             return false;
         
         std::unique_ptr<juce::XmlElement> xml = juce::XmlDocument::parse(file);
-        if (xml == nullptr)
+        if (xml == nullptr || !xml->hasTagName(stateType))
             return false;
         
-        if (!xml->hasTagName(valueTreeState.state.getType()))
+        for (auto* child : xml->getChildWithTagNameIterator("PARAM"))
+        {
+            int index = DX10AudioProcessor::getSnapshotIndex(child->getStringAttribute("id"));
+            if (index >= 0)
+                snapshot.set(index, static_cast<float>(child->getDoubleAttribute("value")));
+        }
+        return true;
+    }
+
+    // presetId is the SelectedPresetId the load selects, recorded in the
+    // same undo step; 0 leaves it as it is.
+    bool loadPresetFromFile(const juce::File& file, int presetId = 0)
+    {
+        // Prefetched presets are applied without touching the disk
+        ParameterSnapshot snapshot;
+        if (!prefetcher.lookup(file, snapshot)
+            && !parsePresetFile(file, valueTreeState.state.getType().toString(), snapshot))
             return false;
         
-        // Begin undo transaction for preset load
-        if (auto* undoManager = valueTreeState.undoManager)
-            undoManager->beginNewTransaction("Load Preset: " + file.getFileNameWithoutExtension());
+        // Hand the whole preset over in one step
+        processor.applyPresetSnapshot(snapshot, file.getFileNameWithoutExtension(), presetId);
         
-        auto newState = juce::ValueTree::fromXml(*xml);
+        setLastLoadedPreset(file.getFullPathName());
         
-        // Set each parameter individually so undo works
-        // Skip PresetIndex and SelectedPresetId - these will be set by the caller
-        for (int i = 0; i < newState.getNumChildren(); ++i)
+        return true;
+    }
+    
+    // Apply one preset of a memory-mapped bank. No file is opened or parsed.
+    bool loadPresetFromBank(const juce::File& bankFile, int index, int presetId = 0)
+    {
+        auto* bank = getBank(bankFile);
+        if (bank == nullptr || index < 0 || index >= bank->getNumPresets())
+            return false;
+        
+        ParameterSnapshot snapshot;
+        for (int p = 0; p < bank->getNumParameters(); ++p)
         {
-            auto child = newState.getChild(i);
-            if (child.hasType("PARAM"))
-            {
-                auto paramId = child.getProperty("id").toString();
-                // Skip internal tracking parameters
-                if (paramId == "PresetIndex" || paramId == "SelectedPresetId")
-                    continue;
-                auto value = static_cast<float>(child.getProperty("value"));
-                if (auto* param = valueTreeState.getParameter(paramId))
-                    param->setValueNotifyingHost(value);
-            }
+            int snapshotIndex = DX10AudioProcessor::getSnapshotIndex(bank->getParameterID(p));
+            if (snapshotIndex >= 0)
+                snapshot.set(snapshotIndex, bank->getParameterValue(index, p));
         }
+        processor.applyPresetSnapshot(snapshot, bank->getPresetName(index), presetId);
         
-        setLastLoadedPreset(file.getFullPathName());
+        setLastLoadedPreset(bankFile.getFullPathName(), index);
         
         return true;
     }
     
+    // Load any entry of the preset list, single file or bank
+    bool loadPreset(const FlatPresetItem& item, int presetId = 0)
+    {
+        if (item.bankIndex >= 0)
+            return loadPresetFromBank(item.file, item.bankIndex, presetId);
+        return loadPresetFromFile(item.file, presetId);
+    }
+    
     // Load last used preset on startup
     bool loadLastPreset()
     {
@@ -169,18 +232,201 @@ public:
         {
             juce::File file(lastLoadedPreset);
             if (file.existsAsFile())
+            {
+                if (lastLoadedBankIndex >= 0)
+                    return loadPresetFromBank(file, lastLoadedBankIndex);
                 return loadPresetFromFile(file);
+            }
         }
         return false;
     }
     
-    // Get flat list with indentation info for combo box
+    // Pack every single-file preset in the library into one bank. Folders are
+    // kept as the preset folder, and an optional "tags" attribute is carried over.
+    int exportPresetsToBank(const juce::File& bankFile) const
+    {
+        juce::StringArray parameterIds;
+        for (int i = 0; i < valueTreeState.state.getNumChildren(); ++i)
+        {
+            auto child = valueTreeState.state.getChild(i);
+            auto paramId = child.getProperty("id").toString();
+            if (child.hasType("PARAM") && paramId != "PresetIndex" && paramId != "SelectedPresetId")
+                parameterIds.add(paramId);
+        }
+        
+        std::vector<PresetBank::Entry> entries;
+        for (const auto& preset : presetIndex)
+        {
+            if (preset.bankIndex >= 0)
+                continue;
+            
+            std::unique_ptr<juce::XmlElement> xml = juce::XmlDocument::parse(preset.file);
+            if (xml == nullptr || !xml->hasTagName(valueTreeState.state.getType().toString()))
+                continue;
+            
+            PresetBank::Entry entry;
+            entry.name = preset.file.getFileNameWithoutExtension();
+            entry.folder = preset.folders.joinIntoString("/");
+            entry.tags = xml->getStringAttribute("tags");
+            
+            for (const auto& paramId : parameterIds)
+            {
+                auto* param = valueTreeState.getParameter(paramId);
+                float value = param != nullptr ? param->getDefaultValue() : 0.0f;
+                if (auto* paramXml = xml->getChildByAttribute("id", paramId))
+                    value = static_cast<float>(paramXml->getDoubleAttribute("value", value));
+                entry.values.push_back(value);
+            }
+            entries.push_back(std::move(entry));
+        }
+        
+        if (!PresetBank::write(bankFile, parameterIds, entries))
+            return -1;
+        return static_cast<int>(entries.size());
+    }
+    
+    // Unpack a bank into single .dx10 files below destination, recreating its folders.
+    int importBank(const juce::File& bankFile, const juce::File& destination) const
+    {
+        auto bank = PresetBank::open(bankFile);
+        if (bank == nullptr)
+            return -1;
+        
+        int written = 0;
+        for (int i = 0; i < bank->getNumPresets(); ++i)
+        {
+            juce::XmlElement xml(valueTreeState.state.getType().toString());
+            for (int p = 0; p < bank->getNumParameters(); ++p)
+            {
+                auto* paramXml = xml.createNewChildElement("PARAM");
+                paramXml->setAttribute("id", bank->getParameterID(p));
+                paramXml->setAttribute("value", bank->getParameterValue(i, p));
+            }
+            
+            auto name = bank->getPresetName(i);
+            xml.setAttribute("presetName", name);
+            xml.setAttribute("pluginVersion", "1.0");
+            if (bank->getPresetTags(i).isNotEmpty())
+                xml.setAttribute("tags", bank->getPresetTags(i));
+            
+            auto folder = destination;
+            for (const auto& part : juce::StringArray::fromTokens(bank->getPresetFolder(i), "/", {}))
+                if (part.isNotEmpty())
+                    folder = folder.getChildFile(juce::File::createLegalFileName(part));
+            
+            auto file = folder.getChildFile(juce::File::createLegalFileName(name) + getPresetExtension());
+            file.getParentDirectory().createDirectory();
+            if (xml.writeTo(file))
+                ++written;
+        }
+        return written;
+    }
+    
+    // Get flat list with indentation info for combo box. Built from the
+    // in-memory index, so it never touches the disk.
     std::vector<FlatPresetItem> getFlatPresetList(int maxDepth = 3) const
     {
         std::vector<FlatPresetItem> items;
-        scanDirectoryFlat(presetDirectory, items, 0, maxDepth);
+        juce::StringArray openFolders;
+        
+        for (const auto& preset : presetIndex)
+        {
+            if (preset.folders.size() > maxDepth)
+                continue;
+            
+            // Close folders we have left, then open the ones this preset lives in
+            int common = 0;
+            while (common < openFolders.size() && common < preset.folders.size()
+                   && openFolders[common] == preset.folders[common])
+                ++common;
+            openFolders.removeRange(common, openFolders.size() - common);
+            
+            for (int d = common; d < preset.folders.size(); ++d)
+            {
+                openFolders.add(preset.folders[d]);
+                auto folder = presetDirectory.getChildFile(openFolders.joinIntoString(juce::File::getSeparatorString()));
+                items.push_back(FlatPresetItem(preset.folders[d], folder, true, d));
+            }
+            
+            items.push_back(FlatPresetItem(preset.name, preset.file, false, preset.folders.size(), preset.bankIndex));
+        }
         return items;
     }
+    
+    // Rebuild the preset index from disk. Only needed on startup, when the
+    // preset directory changes, or when the watcher loses track of events.
+    void rescanPresetDirectory()
+    {
+        scanner.reset();
+        presetIndex.clear();
+        banks.clear();
+        scanDirectory(presetDirectory, presetIndex, banks, nullptr);
+    }
+    
+    // Same as rescanPresetDirectory(), but the disk is walked on a background
+    // thread. The index is swapped in and onDone called on the message thread;
+    // a newer request supersedes one still running.
+    void rescanPresetDirectoryAsync(std::function<void()> onDone)
+    {
+        scanner = std::make_unique<Scanner>(*this, presetDirectory);
+        onScanDone = std::move(onDone);
+        scanner->startThread(juce::Thread::Priority::low);
+    }
+    
+    // Returns the mapped bank for a file in the library, or nullptr
+    const PresetBank* getBank(const juce::File& bankFile) const
+    {
+        auto it = banks.find(bankFile.getFullPathName());
+        return it != banks.end() ? it->second.get() : nullptr;
+    }
+    
+    // Keep these presets parsed in memory (nearest first), e.g. the neighbours
+    // of the current preset. Bank entries are already mapped and are skipped.
+    void prefetch(const std::vector<FlatPresetItem>& items)
+    {
+        juce::Array<juce::File> files;
+        for (const auto& item : items)
+            if (!item.isFolder && item.bankIndex < 0)
+                files.addIfNotAlreadyThere(item.file);
+        prefetcher.setWanted(files);
+    }
+    
+    // Apply add / remove / rename deltas reported by the directory watcher.
+    // Returns true if the index changed.
+    bool applyPresetChanges(const std::vector<PresetChange>& changes)
+    {
+        bool changed = false;
+        
+        for (const auto& change : changes)
+        {
+            // Anything touched on disk must be parsed again
+            prefetcher.invalidate(change.file);
+            if (change.oldFile != juce::File())
+                prefetcher.invalidate(change.oldFile);
+            
+            switch (change.type)
+            {
+                case PresetChange::Type::added:
+                    changed |= addToIndex(change.file, change.isDirectory);
+                    break;
+                    
+                case PresetChange::Type::removed:
+                    changed |= removeFromIndex(change.file);
+                    break;
+                    
+                case PresetChange::Type::renamed:
+                    changed |= removeFromIndex(change.oldFile);
+                    changed |= addToIndex(change.file, change.isDirectory);
+                    break;
+                    
+                case PresetChange::Type::rescanRequired:
+                    rescanPresetDirectory();
+                    changed = true;
+                    break;
+            }
+        }
+        return changed;
+    }
 
     juce::File getPresetFile(const juce::String& presetName) const
     {
@@ -200,38 +446,213 @@ public:
     }
 
 private:
-    void scanDirectoryFlat(const juce::File& dir, std::vector<FlatPresetItem>& items, int depth, int maxDepth) const
+    // A preset file (or one entry of a bank) plus the sub-folders between the
+    // preset directory and it. A bank appears as a folder named after the bank.
+    struct IndexedPreset
+    {
+        juce::File file;
+        juce::String name;
+        juce::StringArray folders;
+        int bankIndex = -1;
+    };
+    
+    static int compareNames(const juce::String& a, const juce::String& b)
+    {
+        return juce::File::areFileNamesCaseSensitive() ? a.compare(b) : a.compareIgnoreCase(b);
+    }
+    
+    // Same order the directory scan used to produce: at each level, folders
+    // (and their contents) come before the presets stored directly in it.
+    static bool comparePresets(const IndexedPreset& a, const IndexedPreset& b)
+    {
+        const int common = juce::jmin(a.folders.size(), b.folders.size());
+        for (int i = 0; i < common; ++i)
+            if (int c = compareNames(a.folders[i], b.folders[i]))
+                return c < 0;
+        
+        if (a.folders.size() != b.folders.size())
+            return a.folders.size() > b.folders.size();
+        
+        if (int c = compareNames(a.name, b.name))
+            return c < 0;
+        
+        if (a.file != b.file)
+            return compareNames(a.file.getFullPathName(), b.file.getFullPathName()) < 0;
+        return a.bankIndex < b.bankIndex;
+    }
+    
+    using BankMap = std::map<juce::String, std::unique_ptr<PresetBank>>;
+    
+    static bool makeIndexedPreset(const juce::File& root, const juce::File& file, IndexedPreset& preset)
     {
-        if (depth > maxDepth) return;
+        if (!file.hasFileExtension(getPresetFileExtensions()) || !file.isAChildOf(root))
+            return false;
+        
+        preset.file = file;
+        preset.name = file.getFileNameWithoutExtension();
+        preset.folders = juce::StringArray::fromTokens(file.getParentDirectory().getRelativePathFrom(root),
+                                                       juce::File::getSeparatorString(), {});
+        preset.folders.removeString(".");
+        preset.folders.removeEmptyStrings();
+        
+        // Hidden folders are not part of the library
+        for (const auto& folder : preset.folders)
+            if (folder.startsWithChar('.'))
+                return false;
+        return true;
+    }
+    
+    // Maps a bank and appends all of its entries (unsorted) to the index
+    static bool appendBankToIndex(const juce::File& root, const juce::File& bankFile,
+                                  std::vector<IndexedPreset>& index, BankMap& bankMap)
+    {
+        IndexedPreset location;
+        if (!makeIndexedPreset(root, bankFile, location))
+            return false;
+        
+        auto bank = PresetBank::open(bankFile);
+        if (bank == nullptr)
+            return false;
         
-        auto children = dir.findChildFiles(juce::File::findFilesAndDirectories, false);
-        children.sort();
+        for (int i = 0; i < bank->getNumPresets(); ++i)
+        {
+            IndexedPreset preset;
+            preset.file = bankFile;
+            preset.name = bank->getPresetName(i);
+            preset.bankIndex = i;
+            preset.folders = location.folders;
+            preset.folders.add(location.name);
+            for (const auto& part : juce::StringArray::fromTokens(bank->getPresetFolder(i), "/", {}))
+                if (part.isNotEmpty())
+                    preset.folders.add(part);
+            index.push_back(std::move(preset));
+        }
         
-        // First add folders and their contents
-        for (int i = 0; i < children.size(); ++i)
+        bankMap[bankFile.getFullPathName()] = std::move(bank);
+        return true;
+    }
+    
+    // Walks the whole preset directory into a sorted index. Touches no members,
+    // so it can run on the scanner thread; returns early if that thread is asked to stop.
+    static void scanDirectory(const juce::File& root, std::vector<IndexedPreset>& index, BankMap& bankMap,
+                              const juce::Thread* thread)
+    {
+        DX10_TRACE_SCOPE("PresetManager::scanDirectory");
+        for (const auto& entry : juce::RangedDirectoryIterator(root, true, getPresetFileWildcard()))
         {
-            const auto& child = children[i];
-            if (child.isDirectory() && !child.getFileName().startsWithChar('.'))
+            if (thread != nullptr && thread->threadShouldExit())
+                return;
+            
+            const auto& file = entry.getFile();
+            if (file.hasFileExtension(PresetBank::getBankExtension()))
+            {
+                appendBankToIndex(root, file, index, bankMap);
+            }
+            else
             {
-                // Check if folder has any presets
-                auto folderPresets = child.findChildFiles(juce::File::findFiles, true, "*" + getPresetExtension());
-                if (folderPresets.size() > 0)
-                {
-                    items.push_back(FlatPresetItem(child.getFileName(), child, true, depth));
-                    scanDirectoryFlat(child, items, depth + 1, maxDepth);
-                }
+                IndexedPreset preset;
+                if (makeIndexedPreset(root, file, preset))
+                    index.push_back(std::move(preset));
             }
         }
+        std::sort(index.begin(), index.end(), comparePresets);
+    }
+    
+    class Scanner : public juce::Thread
+    {
+    public:
+        Scanner(PresetManager& o, const juce::File& directory)
+            : juce::Thread("DX10 Preset Scan"), owner(o), root(directory) {}
         
-        // Then add preset files at this level
-        for (int i = 0; i < children.size(); ++i)
+        ~Scanner() override { stopThread(4000); }
+        
+        void run() override
         {
-            const auto& child = children[i];
-            if (child.hasFileExtension(getPresetExtension()))
+            scanDirectory(root, index, bankMap, this);
+            if (!threadShouldExit())
             {
-                items.push_back(FlatPresetItem(child.getFileNameWithoutExtension(), child, false, depth));
+                finished = true;
+                owner.triggerAsyncUpdate();
             }
         }
+        
+        PresetManager& owner;
+        const juce::File root;
+        std::atomic<bool> finished { false };
+        std::vector<IndexedPreset> index;
+        BankMap bankMap;
+    };
+    
+    void handleAsyncUpdate() override
+    {
+        DX10_TRACE_SCOPE("PresetManager::applyScan");
+        // A stale update from a superseded scan finds the new one still running
+        if (scanner == nullptr || !scanner->finished)
+            return;
+        
+        scanner->waitForThreadToExit(-1);
+        if (scanner->root == presetDirectory)
+        {
+            presetIndex = std::move(scanner->index);
+            banks = std::move(scanner->bankMap);
+        }
+        scanner.reset();
+        
+        if (onScanDone)
+            onScanDone();
+    }
+    
+    bool addToIndex(const juce::File& file, bool isDirectory)
+    {
+        if (isDirectory)
+        {
+            // A whole folder arrived; only its own subtree needs scanning
+            bool changed = false;
+            for (const auto& child : file.findChildFiles(juce::File::findFiles, true, getPresetFileWildcard()))
+                changed |= addToIndex(child, false);
+            return changed;
+        }
+        
+        if (file.hasFileExtension(PresetBank::getBankExtension()))
+        {
+            // A new or rewritten bank replaces all of its previous entries
+            bool removed = removeFromIndex(file);
+            if (!appendBankToIndex(presetDirectory, file, presetIndex, banks))
+                return removed;
+            std::sort(presetIndex.begin(), presetIndex.end(), comparePresets);
+            return true;
+        }
+        
+        IndexedPreset preset;
+        if (!makeIndexedPreset(presetDirectory, file, preset))
+            return false;
+        
+        auto it = std::lower_bound(presetIndex.begin(), presetIndex.end(), preset, comparePresets);
+        if (it != presetIndex.end() && it->file == file && it->bankIndex < 0)
+            return false;
+        
+        presetIndex.insert(it, std::move(preset));
+        return true;
+    }
+    
+    // Removes a preset, or every preset below a removed folder.
+    bool removeFromIndex(const juce::File& fileOrFolder)
+    {
+        for (auto it = banks.begin(); it != banks.end();)
+        {
+            juce::File bankFile(it->first);
+            if (bankFile == fileOrFolder || bankFile.isAChildOf(fileOrFolder))
+                it = banks.erase(it);
+            else
+                ++it;
+        }
+        
+        auto oldSize = presetIndex.size();
+        presetIndex.erase(std::remove_if(presetIndex.begin(), presetIndex.end(),
+                                         [&fileOrFolder](const IndexedPreset& p)
+                                         { return p.file == fileOrFolder || p.file.isAChildOf(fileOrFolder); }),
+                          presetIndex.end());
+        return presetIndex.size() != oldSize;
     }
     
     void loadSettings()
@@ -247,10 +668,17 @@ private:
                     customPresetDirectory = juce::File(customDir);
                 
                 lastLoadedPreset = xml->getStringAttribute("lastLoadedPreset");
+                lastLoadedBankIndex = xml->getIntAttribute("lastLoadedBankIndex", -1);
             }
         }
     }
     
+    void timerCallback() override
+    {
+        stopTimer();
+        saveSettings();
+    }
+    
     void saveSettings()
     {
         auto settingsFile = getSettingsFile();
@@ -261,14 +689,25 @@ private:
             xml.setAttribute("customPresetDirectory", customPresetDirectory.getFullPathName());
         if (lastLoadedPreset.isNotEmpty())
             xml.setAttribute("lastLoadedPreset", lastLoadedPreset);
+        if (lastLoadedBankIndex >= 0)
+            xml.setAttribute("lastLoadedBankIndex", lastLoadedBankIndex);
         
         xml.writeTo(settingsFile);
     }
 
+    DX10AudioProcessor& processor;
     juce::AudioProcessorValueTreeState& valueTreeState;
     juce::File presetDirectory;
     juce::File customPresetDirectory;
     juce::String lastLoadedPreset;
+    int lastLoadedBankIndex = -1;
+    std::vector<IndexedPreset> presetIndex;
+    BankMap banks;
+    PresetPrefetcher prefetcher;
+    std::unique_ptr<Scanner> scanner;
+    std::function<void()> onScanDone;
+    
+    static constexpr int settingsSaveDelayMs = 1000;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetManager)
 };
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include <map>
+#include <functional>
+
+// Keeps the presets around the current one parsed in memory, so stepping
+// through the list applies a cached snapshot instead of reading and parsing
+// a file. Parsing happens on a low priority background thread.
+class PresetPrefetcher : private juce::Thread
+{
+public:
+    // Parses a preset file into a snapshot; called on the prefetch thread.
+    using Parser = std::function<bool(const juce::File&, ParameterSnapshot&)>;
+
+    explicit PresetPrefetcher(Parser presetParser)
+        : juce::Thread("DX10 Preset Prefetch"), parser(std::move(presetParser)) {}
+
+    ~PresetPrefetcher() override
+    {
+        stopThread(2000);
+    }
+
+    // Replace the set of presets to keep in memory, nearest first. Anything no
+    // longer wanted is dropped, so memory stays bounded by the set size.
+    void setWanted(const juce::Array<juce::File>& files)
+    {
+        {
+            const juce::ScopedLock sl(lock);
+            wanted = files;
+
+            for (auto it = cache.begin(); it != cache.end();)
+            {
+                if (!wanted.contains(juce::File(it->first)))
+                    it = cache.erase(it);
+                else
+                    ++it;
+            }
+        }
+
+        if (!isThreadRunning())
+            startThread(juce::Thread::Priority::low);
+        notify();
+    }
+
+    // Returns true and fills snapshot if the file has already been parsed.
+    bool lookup(const juce::File& file, ParameterSnapshot& snapshot) const
+    {
+        const juce::ScopedLock sl(lock);
+        auto it = cache.find(file.getFullPathName());
+        if (it == cache.end() || !it->second.valid)
+            return false;
+        snapshot = it->second.snapshot;
+        return true;
+    }
+
+    // Forget a file (or everything below a folder) after it changed on disk.
+    void invalidate(const juce::File& fileOrFolder)
+    {
+        {
+            const juce::ScopedLock sl(lock);
+            for (auto it = cache.begin(); it != cache.end();)
+            {
+                juce::File cached(it->first);
+                if (cached == fileOrFolder || cached.isAChildOf(fileOrFolder))
+                    it = cache.erase(it);
+                else
+                    ++it;
+            }
+
+            // A parse already under way may have read the old contents
+            if (parsing == fileOrFolder || parsing.isAChildOf(fileOrFolder))
+                parsingInvalidated = true;
+        }
+        notify();
+    }
+
+    static constexpr int radius = 8;  // presets kept on either side of the current one
+
+private:
+    struct Entry
+    {
+        ParameterSnapshot snapshot;
+        bool valid = false;  // false if the file could not be parsed
+    };
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            juce::File next;
+            {
+                const juce::ScopedLock sl(lock);
+                for (const auto& file : wanted)
+                {
+                    if (cache.find(file.getFullPathName()) == cache.end())
+                    {
+                        next = file;
+                        break;
+                    }
+                }
+                parsing = next;
+                parsingInvalidated = false;
+            }
+
+            if (next == juce::File())
+            {
+                wait(-1);
+                continue;
+            }
+
+            Entry entry;
+            entry.valid = parser(next, entry.snapshot);
+
+            // Dropped if the file changed while it was being parsed; it is
+            // still missing from the cache, so the next pass parses it again
+            const juce::ScopedLock sl(lock);
+            if (wanted.contains(next) && !parsingInvalidated)
+                cache[next.getFullPathName()] = entry;
+            parsing = juce::File();
+        }
+    }
+
+    Parser parser;
+    juce::CriticalSection lock;
+    juce::Array<juce::File> wanted;
+    std::map<juce::String, Entry> cache;
+    juce::File parsing;               // file the thread is parsing outside the lock
+    bool parsingInvalidated = false;  // invalidate() covered it since the parse began
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetPrefetcher)
+};
@@ -0,0 +1,326 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <memory>
+#include <functional>
+
+// One searchable preset.
+struct PresetSearchDocument
+{
+    int presetId = 0;       // combo box ID the result selects
+    juce::String name;
+    juce::String folder;    // '/' separated
+    juce::String tags;      // comma separated
+    juce::File tagSource;   // .dx10 file to read a "tags" attribute from, if any
+};
+
+// Immutable trigram + word prefix index over preset names, folders and tags.
+// Terms of three or more characters are matched through the trigram postings,
+// shorter ones through a sorted word list; when nothing matches exactly the
+// query falls back to ranking by shared trigrams, which tolerates typos.
+class PresetSearchIndex
+{
+public:
+    explicit PresetSearchIndex(std::vector<PresetSearchDocument> documents)
+        : docs(std::move(documents))
+    {
+        texts.reserve(docs.size());
+        names.reserve(docs.size());
+
+        for (int id = 0; id < static_cast<int>(docs.size()); ++id)
+        {
+            const auto& doc = docs[static_cast<size_t>(id)];
+            auto text = normalise(doc.name + " " + doc.folder + " " + doc.tags);
+            names.push_back(normalise(doc.name));
+
+            for (const auto& word : juce::StringArray::fromTokens(text, " ", {}))
+                if (word.isNotEmpty())
+                    words.emplace_back(word, id);
+
+            for (int i = 0; i + 2 < text.length(); ++i)
+            {
+                auto& posting = trigrams[key(text[i], text[i + 1], text[i + 2])];
+                if (posting.empty() || posting.back() != id)
+                    posting.push_back(id);
+            }
+
+            texts.push_back(std::move(text));
+        }
+
+        std::sort(words.begin(), words.end());
+    }
+
+    int getNumDocuments() const { return static_cast<int>(docs.size()); }
+    const PresetSearchDocument& getDocument(int index) const { return docs[static_cast<size_t>(index)]; }
+
+    // Returns document indices, best matches first.
+    std::vector<int> search(const juce::String& query) const
+    {
+        auto terms = juce::StringArray::fromTokens(normalise(query), " ", {});
+        terms.removeEmptyStrings();
+
+        std::vector<int> results;
+        if (terms.isEmpty())
+        {
+            results.resize(docs.size());
+            for (size_t i = 0; i < results.size(); ++i)
+                results[i] = static_cast<int>(i);
+            return results;
+        }
+
+        bool first = true;
+        for (const auto& term : terms)
+        {
+            auto matches = term.length() >= 3 ? matchTrigrams(term) : matchPrefix(term);
+            if (first)
+            {
+                results = std::move(matches);
+                first = false;
+            }
+            else
+            {
+                std::vector<int> both;
+                std::set_intersection(results.begin(), results.end(), matches.begin(), matches.end(),
+                                      std::back_inserter(both));
+                results = std::move(both);
+            }
+            if (results.empty())
+                break;
+        }
+
+        if (results.empty())
+            return fuzzyMatch(terms);
+
+        // Name prefix matches first, then name matches, then folder / tag matches
+        auto rank = [this, &terms](int doc)
+        {
+            const auto& name = names[static_cast<size_t>(doc)];
+            if (name.startsWith(terms[0])) return 0;
+            for (const auto& term : terms)
+                if (!name.contains(term)) return 2;
+            return 1;
+        };
+        std::stable_sort(results.begin(), results.end(), [&rank](int a, int b) { return rank(a) < rank(b); });
+        return results;
+    }
+
+private:
+    static juce::String normalise(const juce::String& text)
+    {
+        auto lower = text.toLowerCase();
+        juce::String result;
+        result.preallocateBytes(lower.getNumBytesAsUTF8());
+        for (auto c : lower)
+            result += juce::CharacterFunctions::isLetterOrDigit(c) ? c : ' ';
+        return result;
+    }
+
+    static juce::uint64 key(juce::juce_wchar a, juce::juce_wchar b, juce::juce_wchar c)
+    {
+        return (static_cast<juce::uint64>(a) << 42) | (static_cast<juce::uint64>(b) << 21) | static_cast<juce::uint64>(c);
+    }
+
+    std::vector<juce::uint64> termTrigrams(const juce::String& term) const
+    {
+        std::vector<juce::uint64> keys;
+        for (int i = 0; i + 2 < term.length(); ++i)
+            keys.push_back(key(term[i], term[i + 1], term[i + 2]));
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        return keys;
+    }
+
+    std::vector<int> matchTrigrams(const juce::String& term) const
+    {
+        std::vector<const std::vector<int>*> postings;
+        for (auto k : termTrigrams(term))
+        {
+            auto it = trigrams.find(k);
+            if (it == trigrams.end())
+                return {};
+            postings.push_back(&it->second);
+        }
+
+        // Intersect starting from the rarest trigram
+        std::sort(postings.begin(), postings.end(), [](auto* a, auto* b) { return a->size() < b->size(); });
+        std::vector<int> candidates = *postings.front();
+        for (size_t i = 1; i < postings.size() && !candidates.empty(); ++i)
+        {
+            std::vector<int> both;
+            std::set_intersection(candidates.begin(), candidates.end(), postings[i]->begin(), postings[i]->end(),
+                                  std::back_inserter(both));
+            candidates = std::move(both);
+        }
+
+        // Trigrams can match out of order, so confirm the substring
+        candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                        [this, &term](int doc) { return !texts[static_cast<size_t>(doc)].contains(term); }),
+                         candidates.end());
+        return candidates;
+    }
+
+    std::vector<int> matchPrefix(const juce::String& term) const
+    {
+        std::vector<int> matches;
+        auto it = std::lower_bound(words.begin(), words.end(), std::make_pair(term, -1));
+        for (; it != words.end() && it->first.startsWith(term); ++it)
+            matches.push_back(it->second);
+        std::sort(matches.begin(), matches.end());
+        matches.erase(std::unique(matches.begin(), matches.end()), matches.end());
+        return matches;
+    }
+
+    std::vector<int> fuzzyMatch(const juce::StringArray& terms) const
+    {
+        std::unordered_map<int, int> hits;
+        size_t numTrigrams = 0;
+        for (const auto& term : terms)
+        {
+            for (auto k : termTrigrams(term))
+            {
+                ++numTrigrams;
+                auto it = trigrams.find(k);
+                if (it != trigrams.end())
+                    for (int doc : it->second)
+                        ++hits[doc];
+            }
+        }
+
+        const int required = juce::jmax(1, static_cast<int>(numTrigrams * 6 / 10));
+        std::vector<std::pair<int, int>> scored;
+        for (const auto& hit : hits)
+            if (hit.second >= required)
+                scored.emplace_back(-hit.second, hit.first);
+        std::sort(scored.begin(), scored.end());
+
+        std::vector<int> results;
+        results.reserve(scored.size());
+        for (const auto& s : scored)
+            results.push_back(s.second);
+        return results;
+    }
+
+    std::vector<PresetSearchDocument> docs;
+    std::vector<juce::String> texts;
+    std::vector<juce::String> names;
+    std::vector<std::pair<juce::String, int>> words;
+    std::unordered_map<juce::uint64, std::vector<int>> trigrams;
+};
+
+// Builds a PresetSearchIndex on a background thread and hands it to the
+// message thread once it is ready.
+class PresetSearchIndexer : private juce::Thread,
+                            private juce::AsyncUpdater
+{
+public:
+    PresetSearchIndexer() : juce::Thread("DX10 Preset Indexer") {}
+
+    ~PresetSearchIndexer() override
+    {
+        stopThread(4000);
+        cancelPendingUpdate();
+    }
+
+    // Called on the message thread with each newly built index.
+    std::function<void(std::shared_ptr<const PresetSearchIndex>)> onIndexReady;
+
+    // Start indexing a new document set; a build in progress is superseded.
+    void rebuild(std::vector<PresetSearchDocument> documents)
+    {
+        {
+            const juce::ScopedLock sl(lock);
+            pending = std::move(documents);
+            hasPending = true;
+        }
+
+        if (!isThreadRunning())
+            startThread(juce::Thread::Priority::low);
+        notify();
+    }
+
+    std::shared_ptr<const PresetSearchIndex> getIndex() const
+    {
+        const juce::ScopedLock sl(lock);
+        return index;
+    }
+
+private:
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            std::vector<PresetSearchDocument> documents;
+            {
+                const juce::ScopedLock sl(lock);
+                if (hasPending)
+                {
+                    documents = std::move(pending);
+                    hasPending = false;
+                }
+            }
+
+            if (documents.empty())
+            {
+                wait(-1);
+                continue;
+            }
+
+            for (auto& doc : documents)
+            {
+                if (threadShouldExit())
+                    return;
+                if (doc.tagSource != juce::File())
+                    doc.tags = readTags(doc.tagSource);
+            }
+
+            auto built = std::make_shared<const PresetSearchIndex>(std::move(documents));
+            {
+                const juce::ScopedLock sl(lock);
+                index = std::move(built);
+            }
+            triggerAsyncUpdate();
+        }
+    }
+
+    void handleAsyncUpdate() override
+    {
+        if (onIndexReady)
+            onIndexReady(getIndex());
+    }
+
+    // Reads the optional tags="..." attribute of a preset's root element
+    // from the start of the file, without parsing the whole document.
+    static juce::String readTags(const juce::File& file)
+    {
+        juce::FileInputStream in(file);
+        if (!in.openedOk())
+            return {};
+
+        juce::MemoryBlock head;
+        in.readIntoMemoryBlock(head, 1024);
+        auto text = head.toString();
+        auto rootEnd = text.indexOfChar(text.indexOf("<Parameters"), '>');
+        auto start = text.indexOf("tags=\"");
+        if (start < 0 || (rootEnd >= 0 && start > rootEnd))
+            return {};
+
+        start += 6;
+        auto end = text.indexOfChar(start, '"');
+        if (end < 0)
+            return {};
+
+        return text.substring(start, end)
+                   .replace("&amp;", "&").replace("&lt;", "<").replace("&gt;", ">")
+                   .replace("&quot;", "\"").replace("&apos;", "'");
+    }
+
+    juce::CriticalSection lock;
+    std::vector<PresetSearchDocument> pending;
+    bool hasPending = false;
+    std::shared_ptr<const PresetSearchIndex> index;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetSearchIndexer)
+};
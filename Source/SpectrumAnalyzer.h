@@ -1,14 +1,13 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "TraceRecorder.h"
 
 class SpectrumAnalyzer : public juce::Component,
                           private juce::Timer
 {
 public:
     SpectrumAnalyzer()
-        : forwardFFT(fftOrder),
-          window(fftSize, juce::dsp::WindowingFunction<float>::hann)
     {
         setOpaque(true);
         startTimerHz(30);
@@ -23,7 +22,8 @@ public:
         stopTimer();
     }
 
-    void pushBuffer(const juce::AudioBuffer<float>& buffer)
+    template <typename Sample>
+    void pushBuffer(const juce::AudioBuffer<Sample>& buffer)
     {
         if (buffer.getNumChannels() > 0)
         {
@@ -31,7 +31,7 @@ public:
             
             for (int i = 0; i < buffer.getNumSamples(); ++i)
             {
-                pushNextSampleIntoFifo(channelData[i]);
+                pushNextSampleIntoFifo(static_cast<float>(channelData[i]));
             }
         }
     }
@@ -79,6 +79,7 @@ public:
 private:
     void timerCallback() override
     {
+        DX10_TRACE_SCOPE("SpectrumAnalyzer::timerCallback");
         if (nextFFTBlockReady)
         {
             drawNextFrameOfSpectrum();
@@ -105,10 +106,10 @@ private:
     void drawNextFrameOfSpectrum()
     {
         // Apply window function
-        window.multiplyWithWindowingTable(fftData.data(), fftSize);
+        tables->window.multiplyWithWindowingTable(fftData.data(), fftSize);
         
         // Perform FFT
-        forwardFFT.performFrequencyOnlyForwardTransform(fftData.data());
+        tables->fft.performFrequencyOnlyForwardTransform(fftData.data());
         
         // Convert to dB and smooth
         auto mindB = -100.0f;
@@ -116,12 +117,8 @@ private:
         
         for (size_t i = 0; i < scopeSize; ++i)
         {
-            // Logarithmic frequency mapping
-            auto skewedProportionX = 1.0f - std::exp(std::log(1.0f - static_cast<float>(i) / static_cast<float>(scopeSize)) * 0.2f);
-            auto fftDataIndex = static_cast<size_t>(skewedProportionX * static_cast<float>(fftSize / 2));
-            
             auto level = juce::jmap(juce::jlimit(mindB, maxdB,
-                juce::Decibels::gainToDecibels(fftData[fftDataIndex])
+                juce::Decibels::gainToDecibels(fftData[tables->binForColumn[i]])
                 - juce::Decibels::gainToDecibels(static_cast<float>(fftSize))),
                 mindB, maxdB, 0.0f, 1.0f);
             
@@ -193,8 +190,26 @@ private:
     static constexpr int fftSize = 1 << fftOrder;  // 2048
     static constexpr size_t scopeSize = 256;
 
-    juce::dsp::FFT forwardFFT;
-    juce::dsp::WindowingFunction<float> window;
+    // FFT plan, window and column-to-bin mapping never change, so every
+    // analyzer in the process uses the same copy
+    struct SharedTables
+    {
+        SharedTables()
+        {
+            for (size_t i = 0; i < scopeSize; ++i)
+            {
+                // Logarithmic frequency mapping
+                auto skewedProportionX = 1.0f - std::exp(std::log(1.0f - static_cast<float>(i) / static_cast<float>(scopeSize)) * 0.2f);
+                binForColumn[i] = static_cast<size_t>(skewedProportionX * static_cast<float>(fftSize / 2));
+            }
+        }
+
+        const juce::dsp::FFT fft { fftOrder };
+        const juce::dsp::WindowingFunction<float> window { fftSize, juce::dsp::WindowingFunction<float>::hann };
+        std::array<size_t, scopeSize> binForColumn;
+    };
+
+    juce::SharedResourcePointer<SharedTables> tables;
 
     std::array<float, fftSize> fifo;
     std::array<float, fftSize * 2> fftData;
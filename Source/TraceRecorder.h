@@ -0,0 +1,192 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+
+// Set to 0 to compile all trace scopes out
+#ifndef DX10_ENABLE_TRACING
+ #define DX10_ENABLE_TRACING 1
+#endif
+
+// Records scoped events from any thread into a preallocated buffer and writes
+// them as a Chrome trace (chrome://tracing, ui.perfetto.dev). Recording costs
+// one atomic increment per event; when it is off a scope only reads a flag.
+// Events past the buffer capacity are dropped.
+class TraceRecorder
+{
+public:
+    static constexpr int capacity = 1 << 18;  // events per recording
+
+    static TraceRecorder& getInstance()
+    {
+        static TraceRecorder instance;
+        return instance;
+    }
+
+    ~TraceRecorder()
+    {
+        writer.reset();
+    }
+
+    bool isRecording() const noexcept { return recording.load(std::memory_order_acquire); }
+
+    // Message thread. Ignored while a previous trace is still being written.
+    void start()
+    {
+        if (isRecording() || (writer != nullptr && writer->isThreadRunning()))
+            return;
+
+        if (events == nullptr)
+            events = std::make_unique<Event[]>(static_cast<size_t>(capacity));
+
+        writeIndex.store(0, std::memory_order_relaxed);
+        committed.store(0, std::memory_order_relaxed);
+        originTicks = juce::Time::getHighResolutionTicks();
+        messageThread = juce::Thread::getCurrentThreadId();
+        recording.store(true, std::memory_order_release);
+    }
+
+    // Message thread
+    void stop()
+    {
+        recording.store(false, std::memory_order_release);
+    }
+
+    // Message thread. Writes what the last recording captured on a background
+    // thread, then calls onDone with the result on the message thread.
+    void saveAsync(const juce::File& file, std::function<void(bool)> onDone)
+    {
+        stop();
+        writer = std::make_unique<Writer>(*this, file, std::move(onDone));
+        writer->startThread(juce::Thread::Priority::low);
+    }
+
+    // Any thread
+    void add(const char* name, juce::int64 startTicks, juce::int64 endTicks) noexcept
+    {
+        const int index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+        if (index >= capacity)
+            return;
+
+        events[static_cast<size_t>(index)] = { name, startTicks, endTicks, juce::Thread::getCurrentThreadId() };
+        committed.fetch_add(1, std::memory_order_release);
+    }
+
+private:
+    struct Event
+    {
+        const char* name = nullptr;  // string literal
+        juce::int64 startTicks = 0;
+        juce::int64 endTicks = 0;
+        juce::Thread::ThreadID thread = nullptr;
+    };
+
+    TraceRecorder() = default;
+
+    bool writeTrace(const juce::File& file, const juce::Thread& thread) const
+    {
+        // Wait for scopes that claimed a slot before recording stopped
+        const int claimed = writeIndex.load(std::memory_order_relaxed);
+        const int count = juce::jmin(claimed, capacity);
+        for (int waited = 0; committed.load(std::memory_order_acquire) < count && waited < 100; ++waited)
+            juce::Thread::sleep(1);
+
+        const double ticksPerMicrosecond = static_cast<double>(juce::Time::getHighResolutionTicksPerSecond()) * 1.0e-6;
+        std::map<juce::Thread::ThreadID, int> threadIds { { messageThread, 1 } };
+        std::map<int, juce::String> threadNames { { 1, "Message thread" } };
+
+        juce::MemoryOutputStream out;
+        out << "{\"traceEvents\":[\n";
+
+        for (int i = 0; i < count; ++i)
+        {
+            if (thread.threadShouldExit())
+                return false;
+
+            const auto& event = events[static_cast<size_t>(i)];
+            const auto inserted = threadIds.emplace(event.thread, static_cast<int>(threadIds.size()) + 1);
+            const int tid = inserted.first->second;
+            if (inserted.second)
+                threadNames[tid] = "Thread " + juce::String(tid);
+            if (std::strcmp(event.name, "processBlock") == 0)
+                threadNames[tid] = "Audio thread";
+
+            out << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+                << ",\"ts\":" << juce::String((event.startTicks - originTicks) / ticksPerMicrosecond, 3)
+                << ",\"dur\":" << juce::String((event.endTicks - event.startTicks) / ticksPerMicrosecond, 3) << "},\n";
+        }
+
+        for (const auto& [tid, name] : threadNames)
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+                << ",\"args\":{\"name\":\"" << name << "\"}},\n";
+
+        out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"DX10\"}}\n"
+            << "],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":" << juce::jmax(0, claimed - capacity) << "}}\n";
+
+        return file.replaceWithData(out.getData(), out.getDataSize());
+    }
+
+    class Writer : public juce::Thread
+    {
+    public:
+        Writer(const TraceRecorder& o, const juce::File& f, std::function<void(bool)> done)
+            : juce::Thread("DX10 Trace Writer"), owner(o), file(f), onDone(std::move(done)) {}
+
+        ~Writer() override { stopThread(4000); }
+
+        void run() override
+        {
+            const bool written = owner.writeTrace(file, *this);
+            if (!threadShouldExit() && onDone)
+                juce::MessageManager::callAsync([done = onDone, written]() { done(written); });
+        }
+
+    private:
+        const TraceRecorder& owner;
+        const juce::File file;
+        std::function<void(bool)> onDone;
+    };
+
+    std::unique_ptr<Event[]> events;
+    std::atomic<int> writeIndex { 0 };
+    std::atomic<int> committed { 0 };
+    std::atomic<bool> recording { false };
+    juce::int64 originTicks = 0;
+    juce::Thread::ThreadID messageThread = nullptr;
+    std::unique_ptr<Writer> writer;
+
+    JUCE_DECLARE_NON_COPYABLE(TraceRecorder)
+};
+
+// Adds an event covering its own lifetime while a recording is running
+class TraceScope
+{
+public:
+    explicit TraceScope(const char* eventName) noexcept
+        : name(eventName),
+          startTicks(TraceRecorder::getInstance().isRecording() ? juce::Time::getHighResolutionTicks() : 0)
+    {
+    }
+
+    ~TraceScope()
+    {
+        if (startTicks != 0)
+            TraceRecorder::getInstance().add(name, startTicks, juce::Time::getHighResolutionTicks());
+    }
+
+private:
+    const char* name;
+    const juce::int64 startTicks;
+
+    JUCE_DECLARE_NON_COPYABLE(TraceScope)
+};
+
+#if DX10_ENABLE_TRACING
+ #define DX10_TRACE_SCOPE(name) TraceScope JUCE_JOIN_MACRO(traceScope_, __LINE__) (name)
+#else
+ #define DX10_TRACE_SCOPE(name)
+#endif